@@ -1,33 +1,471 @@
+// Fuente de adquisición; cada variante compila solo sus módulos
+#define ACQ_SRAM    0 // SRAM externa leída entera en continuo
+#define ACQ_TRIGGER 1 // SRAM externa, solo ventanas alrededor de un flanco
+#define ACQ_ADC     2 // ADC interno en modo continuo (sin placa de SRAM)
+#define ACQ_REPLAY  3 // muestras grabadas en /replay.bin (LittleFS)
+#ifndef ACQ_SOURCE
+#define ACQ_SOURCE ACQ_SRAM
+#endif
+#define ACQ_USES_SRAM (ACQ_SOURCE == ACQ_SRAM || ACQ_SOURCE == ACQ_TRIGGER)
+
+// Canales intercalados en la SRAM (fotodiodos del banco, hasta 4). Con más
+// de uno las tramas se separan en planos y la pantalla los superpone.
+#ifndef CHANNELS
+#define CHANNELS 1
+#endif
+
+// 1 = al arrancar, medir SRAM/Pds/Display e informar por UART antes del pipeline
+#ifndef BENCHMARK
+#define BENCHMARK 0
+#endif
+
+// Registro en archivo: 0 = no, 1 = LittleFS, 2 = SD_MMC en 4 bits. Los pines
+// fijos del SDMMC del ESP32 (2, 4, 12-15) chocan con los del TFT: en ese
+// chip la variante con SD va sin pantalla.
+#define LOG_NONE 0
+#define LOG_LITTLEFS 1
+#define LOG_SD 2
+#ifndef LOGGER
+#define LOGGER LOG_NONE
+#endif
+
+// 1 = a batería: sueño ligero entre ráfagas, despierta con el pin de SRAM
+// llena / disparo (GPIO 34). Sin pin conectado se adquiere como siempre.
+#ifndef POWER_SAVE
+#define POWER_SAVE 0
+#endif
+
+// 1 = trazas de etapas; al detectar pérdidas se vuelcan por UART y Net
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#include "trace/trace.cpp"
+#include "spi_bus/spi_bus.cpp"
+#if ACQ_USES_SRAM
 #include "ram_reader/ram_reader.cpp"
+#endif
+#include "frame_pool/frame_pool.cpp"
+#include "codec/codec.cpp"
 #include "uart_comm/uart_comm.cpp"
+#include "display/decimator.cpp"
+#include "display/panel.cpp"
 #include "display/display.cpp"
 #include "peripherals/peripherals.cpp"
 #include "pds/pds.cpp"
-#include "net/net.cpp" 
+#include "pds/spectrum.h"
+#include "pds/pyramid.cpp"
+#include "net/net.cpp"
+#include "net/udp_export.cpp"
+#if LOGGER != LOG_NONE
+#include "logger/logger.cpp"
+#if defined(ARDUINO_ARCH_ESP32) && LOGGER == LOG_SD
+#include <SD_MMC.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <LittleFS.h>
+#endif
+#endif
+#include "pipeline/pipeline.cpp"
+#include "rate/rate_control.cpp"
+#include "command/command.cpp"
+#include "stages/stages.h"
+#if POWER_SAVE
+#include "power/power.cpp"
+#endif
+#if BENCHMARK
+#include "bench/bench.cpp"
+#endif
+#if ACQ_SOURCE == ACQ_SRAM
+#include "source/sram_source.cpp"
+#elif ACQ_SOURCE == ACQ_TRIGGER
+#include "pds/trigger.cpp"
+#include "source/trigger_source.cpp"
+#elif ACQ_SOURCE == ACQ_ADC
+#include "adc_reader/adc_reader.cpp"
+#include "source/adc_source.cpp"
+#elif ACQ_SOURCE == ACQ_REPLAY
+#include "source/replay_source.cpp"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <LittleFS.h>
+#endif
+#endif
+
+// Credenciales Wi-Fi: definir al compilar (-DWIFI_SSID=\"...\") o aquí.
+// Sin SSID no se levanta la red.
+#ifndef WIFI_SSID
+#define WIFI_SSID nullptr
+#endif
+#ifndef WIFI_PASSWORD
+#define WIFI_PASSWORD nullptr
+#endif
 
-RamReader ram(5); // CS en GPIO 5
+#if ACQ_USES_SRAM
+SramConfig sramConfig() {
+  SramConfig cfg;
+  cfg.channels = CHANNELS;
+  return cfg;
+}
+RamReader ram(5, sramConfig()); // CS en GPIO 5
+#endif
 UartComm uartComm;
-Display display;
+// TFT en HSPI (la SRAM usa VSPI): SCK 14, MOSI 13, CS 15, DC 2, RST 4
+PanelConfig tftPins() {
+  PanelConfig cfg;
+  cfg.pinSCK = 14;
+  cfg.pinMOSI = 13;
+  cfg.pinCS = 15;
+  cfg.pinDC = 2;
+  cfg.pinRST = 4;
+  return cfg;
+}
+Display display(tftPins());
 Peripherals peripherals;
 Pds pds;
-Net net;
+Spectrum<256> spectrum; // 50 % de solapamiento
+Pyramid pyramid;        // resúmenes para hacer zoom sobre toda la captura
+FramePool pool;
+Net net(pool);
+Compressor compressor(CODEC_DELTA_PACK);
+UdpExport udpExport; // bloques crudos por multicast, sin pérdidas
+RateControl rate;     // decimación por consumidor según lo que dé cada uno
+CommandChannel commands; // ajustes desde el host por UART o Net
+FrameStages<Spectrum<256>> stages(pds, spectrum, pyramid, display, compressor, uartComm, net);
+#if POWER_SAVE
+PowerScheduler power(peripherals);
+#endif
+
+#if ACQ_SOURCE == ACQ_SRAM
+SramSource source(ram, FRAME_PLANAR);
+#elif ACQ_SOURCE == ACQ_TRIGGER
+Trigger trigger(ram);
+TriggerSource source(trigger);
+#elif ACQ_SOURCE == ACQ_ADC
+AdcReader adc;
+AdcSource source(adc);
+#elif ACQ_SOURCE == ACQ_REPLAY
+#if defined(ARDUINO_ARCH_ESP32)
+File replayFile;
+ReplaySource source(replayFile);
+#else
+ReplaySource source(Serial);
+#endif
+#endif
+Pipeline<decltype(source)> pipeline(source, pool);
+
+// Copia de los ajustes del host por etapa; cada una la renueva entre tramas
+CaptureSettings acqSettings, procSettings, outSettings;
+uint32_t acqSeen = 0, procSeen = 0, outSeen = 0;
+
+#if POWER_SAVE && ACQ_SOURCE == ACQ_SRAM
+// Una ráfaga es una vuelta por la ventana leída, en tramas del pool
+uint32_t sramBurstFrames(const CaptureSettings& s) {
+  const uint32_t size = ram.size();
+  const uint32_t len = s.length ? s.length : (size > s.addr ? size - s.addr : 0);
+  const uint32_t frame = pool.frameBytes();
+  return (len + frame - 1) / frame;
+}
+#endif
+
+// En la tarea de adquisición, antes de cada trama
+bool applyAcquisition() {
+  const CaptureSettings prev = acqSettings;
+  if (commands.snapshot(acqSettings, acqSeen)) {
+#if ACQ_SOURCE == ACQ_SRAM
+    source.setWindow(acqSettings.addr, acqSettings.length);
+#if POWER_SAVE
+    power.setBurstFrames(sramBurstFrames(acqSettings));
+#endif
+#elif ACQ_SOURCE == ACQ_TRIGGER
+    // configure() rearma el barrido: solo si cambió algo del disparo
+    const CaptureSettings& s = acqSettings;
+    if (s.addr != prev.addr || s.length != prev.length || s.trigMode != prev.trigMode ||
+        s.trigLevel != prev.trigLevel || s.trigHysteresis != prev.trigHysteresis ||
+        s.trigPre != prev.trigPre || s.trigPost != prev.trigPost) {
+      TriggerConfig trig = trigger.config();
+      trig.mode = (TriggerMode)s.trigMode;
+      trig.level = s.trigLevel;
+      trig.hysteresis = s.trigHysteresis;
+      trig.preSamples = s.trigPre;
+      trig.postSamples = s.trigPost;
+      trig.base = s.addr;
+      trig.length = s.length;
+      trigger.configure(trig);
+    }
+#endif
+  }
+  (void)prev;
+#if POWER_SAVE
+  if (acqSettings.running) {
+    return power.gate(pipeline.acquireStats().frames, pipeline.outputStats().frames);
+  }
+#endif
+  return acqSettings.running;
+}
+
+#if POWER_SAVE
+// Se duerme con la salida vacía; la SRAM deja CS retenido en alto
+void beforeSleep() {
+#if ACQ_USES_SRAM
+  ram.suspend();
+#endif
+  Serial.flush(); // el UART no transmite dormido
+}
+
+void afterSleep() {
+#if ACQ_USES_SRAM
+  ram.resume();
+#endif
+}
+#endif
+
+#if LOGGER != LOG_NONE
+Logger logger;
+#if defined(ARDUINO_ARCH_ESP32)
+File logData;
+File logIndex;
+#endif
+
+void beginLogger() {
+#if defined(ARDUINO_ARCH_ESP32)
+#if LOGGER == LOG_SD
+  fs::FS& fs = SD_MMC;
+  if (!SD_MMC.begin("/sdcard", false)) return; // false = bus de 4 bits
+#else
+  fs::FS& fs = LittleFS;
+  if (!LittleFS.begin(true)) return;
+#endif
+  logData = fs.open("/capture.lxl", FILE_WRITE);
+  logIndex = fs.open("/capture.idx", FILE_WRITE);
+  if (logData) logger.begin(logData, logIndex ? &logIndex : nullptr);
+#endif
+}
+#endif
+
+// Procesamiento: cadena de filtros de Pds sobre la trama, en su sitio
+void processFrame(Frame& frame) {
+  if (commands.snapshot(procSettings, procSeen)) {
+    PdsConfig filters = pds.config();
+    filters.avgLog2 = procSettings.avgLog2;
+    filters.iirAlpha = procSettings.iirAlpha;
+    filters.decimation = procSettings.decimation;
+    pds.configure(filters); // conserva el estado de los filtros
+  }
+
+  if (procSettings.sinks & STREAM_UDP) {
+    udpExport.send(frame); // crudo, antes de que Pds lo filtre
+    udpExport.poll();
+  }
+  stages.process(frame, procSettings.sinks); // Spectrum, pantalla, Pds y Pyramid
+}
+
+#if TRACE_ENABLED
+bool traceLine(const char* line) {
+  // Sin sitio en alguna de las dos salidas la línea se reintenta después:
+  // el JSON llega entero aunque tarde
+  const size_t len = strlen(line);
+  if (!uartComm.canSend(len) || !net.canSendText(len)) return false;
+  uartComm.send((const uint8_t*)line, len, UART_TYPE_REPORT);
+  net.sendText(line, len);
+  return true;
+}
+
+// Cuando alguna etapa hace esperar a la adquisición, el anillo tiene qué
+// pasó justo antes; como mucho un volcado cada 10 s
+void dumpTraceOnStall() {
+  static uint32_t lastStalls = 0;
+  static uint32_t lastDumpMs = 0;
+  const uint32_t stalls = pipeline.acquireStats().stalls;
+  if (stalls == lastStalls) return;
+  lastStalls = stalls;
+  if (millis() - lastDumpMs < 10000) return;
+  lastDumpMs = millis();
+  Trace::beginDump(); // sale por partes desde la salida y outputIdle()
+}
+#endif
+
+// Salida: paquetes binarios por UART hacia el graficador y pantalla local.
+// Cada consumidor se mide y RateControl lo diezma por separado: el más
+// lento no frena a los demás ni a la adquisición.
+void outputFrame(Frame& frame) {
+  commands.snapshot(outSettings, outSeen);
+  rate.tick(pipeline.outputDepth(), pipeline.acquireStats().stalls);
+  compressor.setCodec(outSettings.codec == CODEC_AUTO ? rate.codec() : (FrameCodec)outSettings.codec);
+  stages.output(frame, outSettings.sinks); // códec, UART, Net y pantalla
+  uartComm.poll(); // comandos del host
+
+#if LOGGER != LOG_NONE
+  logger.push(frame); // comprimida: el archivo rinde más horas
+#endif
+
+#if TRACE_ENABLED
+  dumpTraceOnStall();
+  Trace::dumpSome(traceLine);
+#endif
+}
+
+#if BENCHMARK
+void benchLine(const char* line) {
+  uartComm.send((const uint8_t*)line, strlen(line), UART_TYPE_REPORT);
+}
+
+void runBenchmarks() {
+  Bench bench(benchLine);
+  bench.header();
+#if ACQ_USES_SRAM
+  bench.ramReader(ram);
+#endif
+  bench.pds(pds, pds.config());
+
+  // Una columna de la gráfica por corrida
+  static uint8_t samples[64];
+  for (size_t i = 0; i < sizeof(samples); ++i) samples[i] = i * 4;
+  Frame column = {};
+  column.channels = 1;
+  column.data = samples;
+  column.len = display.decimator().samplesPerColumn();
+  if (column.len > sizeof(samples)) column.len = sizeof(samples);
+  bench.display(display, [&] { display.update(column); });
+}
+#endif
+
+// Sin tramas (p. ej. con la adquisición detenida) se sigue atendiendo al host
+void outputIdle() {
+  net.poll();
+  uartComm.poll();
+#if TRACE_ENABLED
+  Trace::dumpSome(traceLine);
+#endif
+}
+
+// Mensajes del host por Net o UART. Zoom desde la página:
+//   'Z' | primera muestra (8) | cantidad (8) | columnas (2)
+// Respuesta: 'Z' | columnas (2) | muestras totales (8) | min, max, media por columna
+// Cualquier otro es un comando de CommandChannel.
+size_t hostMessage(const uint8_t* data, size_t len, uint8_t* reply, size_t cap) {
+  if (len == 0) return 0;
+  if (data[0] != 'Z') return commands.handle(data, len, reply, cap);
+  if (len < 19 || cap < 11) return 0;
+  uint64_t first, count;
+  uint16_t pixels;
+  memcpy(&first, data + 1, 8); // LE en ambos extremos
+  memcpy(&count, data + 9, 8);
+  memcpy(&pixels, data + 17, 2);
+  const size_t maxPixels = (cap - 11) / sizeof(Summary);
+  if (pixels > maxPixels) pixels = maxPixels;
+
+  const uint64_t total = pyramid.total();
+  const uint16_t n = pyramid.query(first, count, (Summary*)(reply + 11), pixels);
+  reply[0] = 'Z';
+  memcpy(reply + 1, &n, 2);
+  memcpy(reply + 3, &total, 8);
+  return 11 + n * sizeof(Summary);
+}
 
 void setup() {
-  Serial.begin(9600);
+  pool.begin(8, FRAME_BYTES); // el resto se dimensiona con pool.frameBytes()
+  const size_t specBytes = spectrum.bins() * sizeof(uint16_t);
+  uartComm.begin(pool.frameBytes() > specBytes ? pool.frameBytes() : specBytes); // el paquete más grande
+  uartComm.setCodec(CODEC_DELTA_RLE);
+#if ACQ_USES_SRAM
   ram.begin();
+  // El puerto lleva el protocolo binario: el aviso va como paquete de informe
+  char info[48];
+  const int n = snprintf(info, sizeof(info), "SRAM: %lu bytes, direccion de %u bytes",
+                         (unsigned long)ram.size(), ram.addrBytes());
+  uartComm.send((const uint8_t*)info, n, UART_TYPE_REPORT);
+#endif
+
+  // Reloj de muestreo 25, habilitación 26, fin de escritura 27, ganancia 32/33
+  PeripheralsConfig board;
+  board.pinSampleClock = 25;
+  board.pinAdcEnable = 26;
+  board.pinWriteDone = 27;
+  board.pinGain0 = 32;
+  board.pinGain1 = 33;
+  board.samplesPerFrame = pool.frameBytes(); // igual que las tramas del pipeline
+  board.clockInSleep = POWER_SAVE; // la SRAM se llena mientras el MCU duerme
+  peripherals.begin(board);
+
+  PdsConfig filters;
+  filters.avgLog2 = 2;               // media de 4 muestras
+  filters.iirAlpha = Q15(0.25f);
+  pds.begin(filters);
+  pyramid.begin();
+  display.begin(16, CHANNELS);
+
+  NetConfig netCfg;
+  netCfg.ssid = WIFI_SSID;
+  netCfg.password = WIFI_PASSWORD;
+
+  compressor.begin(pool.frameBytes());
+  net.begin(netCfg); // el lote se dimensiona con el tamaño de trama del pool
+  net.onMessage(hostMessage);
+  uartComm.onMessage(hostMessage);
+  udpExport.begin(pool.frameBytes());
+  rate.begin();
+  stages.setRateControl(&rate);
+#if LOGGER != LOG_NONE
+  beginLogger();
+#endif
+#if BENCHMARK
+  runBenchmarks();
+#endif
+  pipeline.onProcess(processFrame);
+  pipeline.onOutput(outputFrame);
+#if ACQ_SOURCE == ACQ_TRIGGER
+  TriggerConfig trig;
+  trig.mode = TRIG_RISING;
+  trig.preSamples = pool.frameBytes() / 4; // la ventana ocupa una trama
+  trig.postSamples = pool.frameBytes() - trig.preSamples;
+  trigger.begin(trig);
+#elif ACQ_SOURCE == ACQ_ADC
+  adc.begin();
+#elif ACQ_SOURCE == ACQ_REPLAY && defined(ARDUINO_ARCH_ESP32)
+  if (LittleFS.begin()) replayFile = LittleFS.open("/replay.bin", "r");
+#endif
+
+  // Lo fijado aquí es el punto de partida; el host lo cambia en marcha
+  CaptureSettings initial;
+  initial.avgLog2 = filters.avgLog2;
+  initial.iirAlpha = filters.iirAlpha;
+  initial.decimation = filters.decimation;
+  uint8_t caps = 0;
+  uint32_t memBytes = 0;
+#if ACQ_USES_SRAM
+  caps |= CAP_WINDOW;
+  memBytes = ram.size();
+#endif
+#if ACQ_SOURCE == ACQ_TRIGGER
+  caps |= CAP_TRIGGER;
+  initial.trigMode = trig.mode;
+  initial.trigLevel = trig.level;
+  initial.trigHysteresis = trig.hysteresis;
+  initial.trigPre = trig.preSamples;
+  initial.trigPost = trig.postSamples;
+#endif
+  commands.begin(initial, caps, memBytes);
+#if POWER_SAVE
+  PowerConfig sleepCfg;
+  sleepCfg.pinWake = 34; // solo entrada, sin pull: lo maneja la placa
+#if ACQ_SOURCE == ACQ_SRAM
+  sleepCfg.burstFrames = sramBurstFrames(initial); // la ventana ya llena
+#elif ACQ_SOURCE == ACQ_TRIGGER
+  sleepCfg.burstFrames = 1; // una ventana por disparo
+#endif
+  sleepCfg.maxSleepMs = 1000; // atender comandos al menos una vez por segundo
+  power.onSleep(beforeSleep, afterSleep);
+  power.begin(sleepCfg);
+#endif
+  pipeline.onAcquire(applyAcquisition);
+  pipeline.onOutputIdle(outputIdle);
+  pipeline.begin(0x0000, pool.frameBytes());
 }
 
 void loop() {
-  if (ram.isReady()) {
-    uint8_t buf[16];
-    ram.readBlock(0x0000, buf, sizeof(buf));
-    Serial.print("Bytes: ");
-    for (uint8_t b : buf) {
-      if (b < 16) Serial.print('0');
-      Serial.print(b, HEX);
-      Serial.print(' ');
-    }
-    Serial.println();
-    delay(1000);
-  }
+#if defined(ARDUINO_ARCH_ESP32)
+  // El trabajo lo hacen las tareas de Pipeline
+  vTaskDelete(NULL);
+#else
+  pipeline.poll();
+#endif
 }
@@ -0,0 +1,115 @@
+#include "adc_reader.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+// Formato de resultado según el chip (ver ejemplo continuous_read de IDF)
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_READER_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_READER_DATA(p) ((p)->type1.data)
+#else
+#define ADC_READER_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_READER_DATA(p) ((p)->type2.data)
+#endif
+
+AdcReader::AdcReader()
+    : _running(false), _samples(0), _overruns(0), _handle(nullptr), _raw(nullptr), _rawCap(0) {}
+
+bool AdcReader::begin(const AdcConfig& cfg) {
+    if (_running) return true;
+    _cfg = cfg;
+    if (_cfg.sampleRateHz < SOC_ADC_SAMPLE_FREQ_THRES_LOW) _cfg.sampleRateHz = SOC_ADC_SAMPLE_FREQ_THRES_LOW;
+    if (_cfg.sampleRateHz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) _cfg.sampleRateHz = SOC_ADC_SAMPLE_FREQ_THRES_HIGH;
+    // El driver exige múltiplos del tamaño de resultado
+    _cfg.dmaFrameBytes -= _cfg.dmaFrameBytes % SOC_ADC_DIGI_RESULT_BYTES;
+
+    adc_unit_t unit;
+    adc_channel_t channel;
+    if (adc_continuous_io_to_channel(_cfg.pin, &unit, &channel) != ESP_OK || unit != ADC_UNIT_1) {
+        return false; // ADC2 no admite modo continuo junto con Wi-Fi
+    }
+
+    adc_continuous_handle_cfg_t handleCfg = {};
+    handleCfg.max_store_buf_size = _cfg.dmaBufferBytes;
+    handleCfg.conv_frame_size = _cfg.dmaFrameBytes;
+    if (adc_continuous_new_handle(&handleCfg, &_handle) != ESP_OK) return false;
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = _cfg.atten;
+    pattern.channel = channel;
+    pattern.unit = unit;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_continuous_config_t digCfg = {};
+    digCfg.pattern_num = 1;
+    digCfg.adc_pattern = &pattern;
+    digCfg.sample_freq_hz = _cfg.sampleRateHz;
+    digCfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digCfg.format = ADC_READER_FORMAT;
+
+    adc_continuous_evt_cbs_t cbs = {};
+    cbs.on_pool_ovf = onPoolOverflow;
+
+    _rawCap = _cfg.dmaFrameBytes;
+    _raw = (uint8_t*)malloc(_rawCap);
+    if (!_raw || adc_continuous_config(_handle, &digCfg) != ESP_OK ||
+        adc_continuous_register_event_callbacks(_handle, &cbs, this) != ESP_OK ||
+        adc_continuous_start(_handle) != ESP_OK) {
+        end();
+        return false;
+    }
+    _running = true;
+    return true;
+}
+
+void AdcReader::end() {
+    if (_handle) {
+        if (_running) adc_continuous_stop(_handle);
+        adc_continuous_deinit(_handle);
+        _handle = nullptr;
+    }
+    free(_raw);
+    _raw = nullptr;
+    _running = false;
+}
+
+bool IRAM_ATTR AdcReader::onPoolOverflow(adc_continuous_handle_t, const adc_continuous_evt_data_t*,
+                                         void* arg) {
+    ++static_cast<AdcReader*>(arg)->_overruns;
+    return false;
+}
+
+size_t AdcReader::readFrame(uint8_t* dst, size_t len) {
+    if (!_running || !dst || len == 0) return 0;
+
+    // Se lee de a lo sumo len resultados; el resto queda en el anillo
+    size_t want = len * SOC_ADC_DIGI_RESULT_BYTES;
+    if (want > _rawCap) {
+        want = _rawCap;
+        len = want / SOC_ADC_DIGI_RESULT_BYTES;
+    }
+    uint32_t got = 0;
+    if (adc_continuous_read(_handle, _raw, want, &got, 0) != ESP_OK || got < want) {
+        // Con timeout 0 el driver entrega lo que haya: no se parten tramas,
+        // pero tampoco se pierde lo leído
+        if (got == 0) return 0;
+        len = got / SOC_ADC_DIGI_RESULT_BYTES;
+    }
+
+    // 12 bits -> 8 bits, como las muestras de la SRAM
+    for (size_t i = 0; i < len; ++i) {
+        const adc_digi_output_data_t* p =
+            (const adc_digi_output_data_t*)(_raw + i * SOC_ADC_DIGI_RESULT_BYTES);
+        dst[i] = ADC_READER_DATA(p) >> (SOC_ADC_DIGI_MAX_BITWIDTH - 8);
+    }
+    _samples += len;
+    return len;
+}
+
+#else
+
+AdcReader::AdcReader() : _running(false), _samples(0), _overruns(0) {}
+bool AdcReader::begin(const AdcConfig& cfg) { _cfg = cfg; return false; }
+void AdcReader::end() {}
+size_t AdcReader::readFrame(uint8_t*, size_t) { return 0; }
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef ADC_READER_H
+#define ADC_READER_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_adc/adc_continuous.h>
+#endif
+
+struct AdcConfig {
+    int8_t   pin = 36;              // GPIO del fotodiodo (ADC1; en ESP32 GPIO36 = canal 0)
+    uint32_t sampleRateHz = 200000; // se recorta al máximo del chip
+    uint8_t  atten = 3;             // ADC_ATTEN_DB_12: 0..~3.1 V
+    size_t   dmaFrameBytes = 1024;  // bytes de resultado por interrupción del DMA
+    size_t   dmaBufferBytes = 8192; // anillo del driver entre DMA y read()
+};
+
+// Adquisición directa con el ADC interno en modo continuo (DMA), para
+// bancos sin la placa de SRAM. El DMA llena el anillo del driver sin
+// intervención de la CPU; readFrame() convierte los resultados (12 bits
+// con canal) a muestras de 8 bits como las de la SRAM, así Pds, Display y
+// Net no distinguen el origen.
+class AdcReader {
+public:
+    AdcReader();
+    bool begin(const AdcConfig& cfg = AdcConfig());
+    void end();
+    bool isReady() const { return _running; }
+    uint32_t sampleRate() const { return _cfg.sampleRateHz; }
+
+    // No bloquea: copia hasta len muestras de las ya convertidas por el DMA
+    // y devuelve cuántas (0 si no había ninguna)
+    size_t readFrame(uint8_t* dst, size_t len);
+
+    uint32_t samples() const { return _samples; }
+    uint32_t overruns() const { return _overruns; } // el anillo del driver se llenó
+
+private:
+    AdcConfig _cfg;
+    bool _running;
+    uint32_t _samples;
+    uint32_t _overruns;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static bool IRAM_ATTR onPoolOverflow(adc_continuous_handle_t handle,
+                                         const adc_continuous_evt_data_t* edata, void* arg);
+    adc_continuous_handle_t _handle;
+    uint8_t* _raw;    // resultados del driver antes de convertir
+    size_t _rawCap;
+#endif
+};
+
+#endif // ADC_READER_H
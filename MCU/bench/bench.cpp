@@ -0,0 +1,41 @@
+#include "bench.h"
+#include <algorithm>
+
+Bench::Bench(BenchSink sink, uint16_t runs) : _sink(sink) {
+    _runs = (runs == 0) ? 1 : (runs > MAX_RUNS ? MAX_RUNS : runs);
+}
+
+uint32_t Bench::cyclesPerUs() {
+#if defined(ARDUINO_ARCH_ESP32)
+    return getCpuFrequencyMhz();
+#else
+    return 1; // Peripherals::cycles() da micros()
+#endif
+}
+
+void Bench::finish(BenchResult& r) {
+    std::sort(_samples, _samples + r.runs);
+    const auto pct = [&](uint32_t p) { return _samples[(r.runs - 1) * p / 100]; };
+    r.p50 = pct(50);
+    r.p90 = pct(90);
+    r.p99 = pct(99);
+    r.max = _samples[r.runs - 1];
+}
+
+void Bench::header() {
+    if (_sink) _sink("name,param,runs,bytes,p50_us,p90_us,p99_us,max_us,MBps,ksps");
+}
+
+void Bench::report(const BenchResult& r) {
+    if (!_sink) return;
+
+    // Caudal sobre la mediana: los valores altos suelen ser interrupciones
+    const float mhz = cyclesPerUs();
+    const float p50us = r.p50 / mhz;
+    const float mbps = (p50us > 0) ? r.bytes / p50us : 0; // bytes/us = MB/s
+    char line[128];
+    snprintf(line, sizeof(line), "%s,%lu,%u,%lu,%.2f,%.2f,%.2f,%.2f,%.3f,%.1f",
+             r.name, (unsigned long)r.param, r.runs, (unsigned long)r.bytes,
+             p50us, r.p90 / mhz, r.p99 / mhz, r.max / mhz, mbps, mbps * 1000.0f);
+    _sink(line);
+}
@@ -0,0 +1,130 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+#include "../peripherals/peripherals.h"
+#include "../ram_reader/ram_reader.h" // solo tipos; ramReader() es plantilla
+
+// Resultado de una medición: latencias en ciclos de CPU por corrida
+struct BenchResult {
+    const char* name;
+    uint32_t param;    // tamaño de bloque, reloj... según la prueba
+    uint16_t runs;
+    uint32_t bytes;    // bytes (o muestras) procesados por corrida
+    uint32_t p50, p90, p99, max;
+};
+
+// Receptor de las líneas del informe (CSV, sin salto de línea)
+typedef void (*BenchSink)(const char* line);
+
+// Banco de pruebas en el equipo. Cada medición repite la operación `runs`
+// veces, toma el contador de ciclos antes y después de cada una y reporta
+// percentiles y caudal. Las suites son plantillas: solo se compilan las que
+// se llaman, así una variante sin SRAM no arrastra RamReader.
+class Bench {
+public:
+    static constexpr uint16_t MAX_RUNS = 128;
+
+    Bench(BenchSink sink, uint16_t runs = 64);
+
+    template <typename F>
+    BenchResult measure(const char* name, uint32_t param, uint32_t bytes, F&& fn);
+    void report(const BenchResult& r);
+    void header();
+
+    // Barridos de tamaño de bloque, reloj y modo de lectura; deja la SRAM
+    // como estaba
+    template <typename Reader> void ramReader(Reader& ram);
+    // Kernels de Pds con distintas configuraciones de la cadena
+    template <typename P, typename Config> void pds(P& pds, const Config& base);
+    // Redibujado completo e incremental
+    template <typename D, typename F> void display(D& display, F&& feed);
+
+    static uint32_t cyclesPerUs();
+
+private:
+    void finish(BenchResult& r);
+
+    BenchSink _sink;
+    uint16_t _runs;
+    uint32_t _samples[MAX_RUNS];
+    uint8_t _buf[4096]; // datos de prueba / destino de lecturas
+};
+
+template <typename F>
+BenchResult Bench::measure(const char* name, uint32_t param, uint32_t bytes, F&& fn) {
+    BenchResult r = {name, param, _runs, bytes, 0, 0, 0, 0};
+    fn(); // la primera corrida calienta la caché de flash
+    for (uint16_t i = 0; i < _runs; ++i) {
+        const uint32_t t0 = Peripherals::cycles();
+        fn();
+        _samples[i] = Peripherals::cycles() - t0;
+    }
+    finish(r);
+    report(r);
+    return r;
+}
+
+template <typename Reader>
+void Bench::ramReader(Reader& ram) {
+    static const uint16_t BLOCKS[] = {1, 16, 64, 256, 512, 1024, 4096};
+    static const uint32_t CLOCKS[] = {1'000'000, 5'000'000, 10'000'000, 20'000'000};
+    static const SramReadMode MODES[] = {SRAM_READ, SRAM_FAST_READ};
+    static const char* const MODE_NAMES[] = {"read", "fast_read"};
+
+    const SramReadMode mode0 = ram.readMode();
+    const uint32_t clock0 = ram.clock();
+
+    // Costo fijo por acceso: comando + dirección (+ dummy) + 1 byte
+    measure("ram.readByte", clock0, 1, [&] { _buf[0] = ram.readByte(0); });
+
+    for (uint8_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); ++m) {
+        ram.setReadMode(MODES[m]);
+        for (uint32_t hz : CLOCKS) {
+            ram.setClock(hz);
+            char name[32];
+            snprintf(name, sizeof(name), "ram.%s@%luk", MODE_NAMES[m], (unsigned long)(hz / 1000));
+            for (uint16_t len : BLOCKS) {
+                measure(name, len, len, [&] { ram.readBlock(0, _buf, len); });
+            }
+        }
+    }
+
+    ram.setReadMode(mode0);
+    ram.setClock(clock0);
+}
+
+template <typename P, typename Config>
+void Bench::pds(P& pds, const Config& base) {
+    static const uint16_t LENS[] = {16, 128, 512};
+    int16_t out[512];
+    for (size_t i = 0; i < sizeof(_buf); ++i) _buf[i] = 128 + (i % 64) - 32;
+
+    struct Variant { const char* name; uint8_t avgLog2; int16_t alpha; uint8_t decimation; };
+    static const Variant VARIANTS[] = {
+        {"pds.passthrough", 0, 0, 1},
+        {"pds.avg16", 4, 0, 1},
+        {"pds.iir", 0, 8192, 1},
+        {"pds.avg4+iir+dec4", 2, 8192, 4},
+    };
+    for (const Variant& v : VARIANTS) {
+        Config cfg = base;
+        cfg.avgLog2 = v.avgLog2;
+        cfg.iirAlpha = v.alpha;
+        cfg.decimation = v.decimation;
+        pds.configure(cfg);
+        for (uint16_t len : LENS) {
+            measure(v.name, len, len, [&] { pds.process(_buf, len, out); });
+        }
+    }
+    pds.configure(base);
+}
+
+template <typename D, typename F>
+void Bench::display(D& display, F&& feed) {
+    // feed() mete en la gráfica las muestras de una columna nueva
+    measure("display.full", 0, 0, [&] { display.invalidate(); display.render(); });
+    measure("display.column", 0, 0, [&] { feed(); display.render(); });
+}
+
+#endif // BENCH_H
@@ -0,0 +1,201 @@
+#include "codec.h"
+
+Compressor::Compressor(FrameCodec codec)
+    : _codec(codec), _scratch(nullptr), _delta(nullptr), _maxLen(0),
+      _rawBytes(0), _packedBytes(0) {}
+
+bool Compressor::begin(size_t maxLen) {
+    if (_scratch) return true;
+    _scratch = (uint8_t*)malloc(maxLen);
+    _delta = (uint8_t*)malloc(maxLen);
+    if (!_scratch || !_delta) { end(); return false; }
+    _maxLen = maxLen;
+    return true;
+}
+
+void Compressor::end() {
+    free(_scratch);
+    free(_delta);
+    _scratch = nullptr;
+    _delta = nullptr;
+    _maxLen = 0;
+}
+
+bool Compressor::compress(Frame& frame) {
+    if (frame.codec != CODEC_RAW || frame.len == 0 || frame.len > _maxLen) return false;
+
+    const size_t n = encode(frame.data, frame.len, _scratch, frame.len - 1);
+    _rawBytes += frame.len;
+    if (n == 0) {
+        _packedBytes += frame.len;
+        return false;
+    }
+    memcpy(frame.data, _scratch, n);
+    frame.len = n;
+    frame.codec = _codec;
+    _packedBytes += n;
+    return true;
+}
+
+size_t Compressor::encode(const uint8_t* src, size_t len, uint8_t* dst, size_t cap) {
+    switch (_codec) {
+        case CODEC_RLE:
+            return packBits(src, len, dst, cap);
+        case CODEC_DELTA_RLE: {
+            if (!_delta || len == 0 || len > _maxLen) return 0;
+            uint8_t prev = 0;
+            for (size_t i = 0; i < len; ++i) {
+                _delta[i] = src[i] - prev;
+                prev = src[i];
+            }
+            return packBits(_delta, len, dst, cap);
+        }
+        case CODEC_DELTA_PACK:
+            return deltaPack(src, len, dst, cap);
+        default:
+            return 0;
+    }
+}
+
+size_t Compressor::packBits(const uint8_t* src, size_t len, uint8_t* dst, size_t cap) {
+    // Control n: 0..127 -> n+1 literales; -1..-127 -> repetir 1-n veces el siguiente
+    size_t in = 0, out = 0;
+    while (in < len) {
+        size_t run = 1;
+        while (in + run < len && run < 128 && src[in + run] == src[in]) ++run;
+
+        if (run >= 2) {
+            if (out + 2 > cap) return 0;
+            dst[out++] = (uint8_t)(1 - (int)run);
+            dst[out++] = src[in];
+            in += run;
+            continue;
+        }
+
+        // Literales hasta el próximo par repetido
+        size_t lit = 1;
+        while (in + lit < len && lit < 128 &&
+               !(in + lit + 1 < len && src[in + lit] == src[in + lit + 1])) {
+            ++lit;
+        }
+        if (out + 1 + lit > cap) return 0;
+        dst[out++] = (uint8_t)(lit - 1);
+        memcpy(dst + out, src + in, lit);
+        out += lit;
+        in += lit;
+    }
+    return out;
+}
+
+static inline uint8_t zigzag(uint8_t d) {
+    // -1 -> 1, 1 -> 2, -2 -> 3...: las diferencias chicas quedan en pocos bits
+    return (uint8_t)((d << 1) ^ (uint8_t)((int8_t)d >> 7));
+}
+
+static inline uint8_t unzigzag(uint8_t z) {
+    return (uint8_t)((z >> 1) ^ (uint8_t)-(z & 1));
+}
+
+size_t Compressor::deltaPack(const uint8_t* src, size_t len, uint8_t* dst, size_t cap) {
+    if (len == 0 || len > UINT16_MAX || cap < 3) return 0;
+    dst[0] = len & 0xFF;
+    dst[1] = len >> 8;
+    dst[2] = src[0];
+    size_t out = 3;
+
+    uint8_t prev = src[0];
+    for (size_t i = 1; i < len; i += BLOCK) {
+        const size_t n = (len - i < BLOCK) ? len - i : BLOCK;
+        uint8_t z[BLOCK];
+        uint8_t any = 0;
+        for (size_t k = 0; k < n; ++k) {
+            z[k] = zigzag(src[i + k] - prev);
+            prev = src[i + k];
+            any |= z[k];
+        }
+        const uint8_t width = any ? 32 - __builtin_clz(any) : 0;
+        const size_t bytes = (n * width + 7) / 8;
+        if (out + 1 + bytes > cap) return 0;
+        dst[out++] = width;
+        if (width == 0) continue;
+
+        uint32_t acc = 0;
+        uint8_t bits = 0;
+        for (size_t k = 0; k < n; ++k) {
+            acc |= (uint32_t)z[k] << bits;
+            bits += width;
+            while (bits >= 8) {
+                dst[out++] = acc & 0xFF;
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+        if (bits) dst[out++] = acc & 0xFF;
+    }
+    return out;
+}
+
+size_t Compressor::decode(FrameCodec codec, const uint8_t* src, size_t len,
+                          uint8_t* dst, size_t cap) {
+    switch (codec) {
+        case CODEC_RAW: {
+            const size_t n = len < cap ? len : cap;
+            memcpy(dst, src, n);
+            return n;
+        }
+        case CODEC_RLE:
+        case CODEC_DELTA_RLE: {
+            size_t in = 0, out = 0;
+            while (in < len) {
+                const int8_t c = (int8_t)src[in++];
+                if (c >= 0) {
+                    const size_t lit = c + 1;
+                    if (in + lit > len || out + lit > cap) return 0;
+                    memcpy(dst + out, src + in, lit);
+                    in += lit;
+                    out += lit;
+                } else {
+                    const size_t run = 1 - c;
+                    if (in >= len || out + run > cap) return 0;
+                    memset(dst + out, src[in++], run);
+                    out += run;
+                }
+            }
+            if (codec == CODEC_DELTA_RLE) {
+                uint8_t prev = 0;
+                for (size_t i = 0; i < out; ++i) prev = dst[i] = prev + dst[i];
+            }
+            return out;
+        }
+        case CODEC_DELTA_PACK: {
+            if (len < 3) return 0; // cuenta (2) + primera muestra
+            const size_t count = src[0] | (src[1] << 8);
+            if (count == 0 || count > cap) return 0; // deltaPack nunca emite 0
+            uint8_t prev = dst[0] = src[2];
+            size_t in = 3;
+            for (size_t i = 1; i < count; i += BLOCK) {
+                const size_t n = (count - i < BLOCK) ? count - i : BLOCK;
+                if (in >= len) return 0;
+                const uint8_t width = src[in++];
+                if (width > 8 || in + (n * width + 7) / 8 > len) return 0;
+                const uint8_t mask = (1u << width) - 1;
+
+                uint32_t acc = 0;
+                uint8_t bits = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    while (bits < width) {
+                        acc |= (uint32_t)src[in++] << bits;
+                        bits += 8;
+                    }
+                    prev += unzigzag(acc & mask);
+                    dst[i + k] = prev;
+                    acc >>= width;
+                    bits -= width;
+                }
+            }
+            return count;
+        }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+
+// Codificación de la carga de una trama (Frame::codec y cabecera UART)
+enum FrameCodec : uint8_t {
+    CODEC_RAW        = 0,
+    CODEC_RLE        = 1, // PackBits
+    CODEC_DELTA_RLE  = 2, // diferencias entre muestras + PackBits
+    CODEC_DELTA_PACK = 3, // diferencias + zigzag + empaquetado de bits
+};
+
+// Compresión de tramas de intensidad. La señal varía despacio, así que las
+// diferencias entre muestras caben en 1-3 bits casi siempre.
+//
+// CODEC_DELTA_PACK (LE):
+//   cantidad (2) | primera muestra (1) | por bloque de 16 diferencias:
+//   ancho en bits (1, 0..8) | 16*ancho/8 bytes, bit menos significativo primero
+// El último bloque puede ser más corto; su tamaño sale de la cantidad.
+class Compressor {
+public:
+    static constexpr size_t BLOCK = 16;
+
+    Compressor(FrameCodec codec = CODEC_DELTA_PACK);
+    bool begin(size_t maxLen = FRAME_BYTES);
+    void end();
+    void setCodec(FrameCodec codec) { _codec = codec; }
+    FrameCodec codec() const { return _codec; }
+
+    // Comprime la trama en su sitio y anota el códec en frame.codec. Si no
+    // reduce el tamaño la deja como está (CODEC_RAW).
+    bool compress(Frame& frame);
+    // Codifica hacia dst; 0 si el resultado no cabe en cap (mandar en crudo)
+    size_t encode(const uint8_t* src, size_t len, uint8_t* dst, size_t cap);
+    // Inversa, para el host o las pruebas. Devuelve las muestras escritas.
+    static size_t decode(FrameCodec codec, const uint8_t* src, size_t len,
+                         uint8_t* dst, size_t cap);
+
+    uint32_t rawBytes() const { return _rawBytes; }       // entrada acumulada
+    uint32_t packedBytes() const { return _packedBytes; } // salida acumulada
+
+    static size_t packBits(const uint8_t* src, size_t len, uint8_t* dst, size_t cap);
+    static size_t deltaPack(const uint8_t* src, size_t len, uint8_t* dst, size_t cap);
+
+private:
+    FrameCodec _codec;
+    uint8_t* _scratch; // salida del códec antes de copiarla a la trama
+    uint8_t* _delta;   // diferencias para CODEC_DELTA_RLE
+    size_t _maxLen;
+    uint32_t _rawBytes;
+    uint32_t _packedBytes;
+};
+
+#endif // CODEC_H
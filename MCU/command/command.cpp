@@ -0,0 +1,128 @@
+#include "command.h"
+
+static void cmdPut16(uint8_t* p, uint16_t v) { memcpy(p, &v, 2); } // LE en ambos extremos
+static void cmdPut32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+static uint16_t cmdGet16(const uint8_t* p) { uint16_t v; memcpy(&v, p, 2); return v; }
+static uint32_t cmdGet32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+void CommandChannel::begin(const CaptureSettings& initial, uint8_t caps, uint32_t memBytes) {
+    _caps = caps;
+    _memBytes = memBytes;
+    _staged = initial;
+    publish(_staged);
+}
+
+void CommandChannel::publish(const CaptureSettings& s) {
+    // Versión impar durante la copia: los lectores reintentan
+    const uint32_t v = _version.load(std::memory_order_relaxed);
+    _version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _settings = s;
+    _version.store(v + 2, std::memory_order_release);
+}
+
+bool CommandChannel::snapshot(CaptureSettings& out, uint32_t& seen) const {
+    for (;;) {
+        const uint32_t v = _version.load(std::memory_order_acquire);
+        if (v == seen) return false;
+        if (v & 1) continue;
+        out = _settings;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_version.load(std::memory_order_relaxed) != v) continue;
+        seen = v;
+        return true;
+    }
+}
+
+CommandStatus CommandChannel::apply(const uint8_t* data, size_t len, CaptureSettings& s) const {
+    const uint8_t* a = data + 1;
+    const size_t n = len - 1;
+    switch (data[0]) {
+        case CMD_WINDOW:
+            if (!(_caps & CAP_WINDOW)) return CMD_UNSUPPORTED;
+            if (n != 8) return CMD_BAD_LENGTH;
+            s.addr = cmdGet32(a);
+            s.length = cmdGet32(a + 4);
+            if (_memBytes && (s.addr >= _memBytes || s.length > _memBytes - s.addr)) return CMD_BAD_VALUE;
+            return CMD_OK;
+        case CMD_STRIDE:
+            if (n != 1) return CMD_BAD_LENGTH;
+            if (a[0] == 0) return CMD_BAD_VALUE;
+            s.decimation = a[0];
+            return CMD_OK;
+        case CMD_TRIGGER:
+            if (!(_caps & CAP_TRIGGER)) return CMD_UNSUPPORTED;
+            if (n != 7) return CMD_BAD_LENGTH;
+            if (a[0] > 4) return CMD_BAD_VALUE; // TRIG_PULSE
+            s.trigMode = a[0];
+            s.trigLevel = a[1];
+            s.trigHysteresis = a[2];
+            s.trigPre = cmdGet16(a + 3);
+            s.trigPost = cmdGet16(a + 5);
+            return CMD_OK;
+        case CMD_FILTER: {
+            if (n != 3) return CMD_BAD_LENGTH;
+            const int16_t alpha = (int16_t)cmdGet16(a + 1);
+            if (a[0] > 6 || alpha < 0) return CMD_BAD_VALUE;
+            s.avgLog2 = a[0];
+            s.iirAlpha = alpha;
+            return CMD_OK;
+        }
+        case CMD_STREAM:
+            if (n != 2) return CMD_BAD_LENGTH;
+            if (a[0] & ~STREAM_ALL) return CMD_BAD_VALUE;
+            if (a[1] != CODEC_AUTO && a[1] > CODEC_DELTA_PACK) return CMD_BAD_VALUE;
+            s.sinks = a[0];
+            s.codec = a[1];
+            return CMD_OK;
+        case CMD_START:
+        case CMD_STOP:
+            if (n != 0) return CMD_BAD_LENGTH;
+            s.running = (data[0] == CMD_START);
+            return CMD_OK;
+        case CMD_STATUS:
+            return CMD_OK;
+        default:
+            return CMD_UNKNOWN;
+    }
+}
+
+size_t CommandChannel::handle(const uint8_t* data, size_t len, uint8_t* reply, size_t cap) {
+    if (!data || len == 0) return 0;
+
+    // Se valida sobre una copia: un comando rechazado no deja nada a medias
+    CaptureSettings next = _staged;
+    const CommandStatus status = apply(data, len, next);
+    if (status == CMD_OK) {
+        ++_commands;
+        if (data[0] != CMD_STATUS) {
+            _staged = next;
+            publish(_staged);
+        }
+    } else {
+        ++_rejected;
+    }
+
+    if (!reply || cap < REPLY_BYTES) return 0;
+    reply[0] = data[0];
+    reply[1] = status;
+    encode(_staged, reply + 2);
+    return REPLY_BYTES;
+}
+
+void CommandChannel::encode(const CaptureSettings& s, uint8_t* out) {
+    // Mismo orden que CaptureSettings
+    cmdPut32(out, s.addr);
+    cmdPut32(out + 4, s.length);
+    out[8] = s.decimation;
+    out[9] = s.avgLog2;
+    cmdPut16(out + 10, (uint16_t)s.iirAlpha);
+    out[12] = s.trigMode;
+    out[13] = s.trigLevel;
+    out[14] = s.trigHysteresis;
+    cmdPut16(out + 15, s.trigPre);
+    cmdPut16(out + 17, s.trigPost);
+    out[19] = s.sinks;
+    out[20] = s.codec;
+    out[21] = s.running;
+}
@@ -0,0 +1,107 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "../codec/codec.h"
+
+// Comandos del host, iguales por UART (paquete UART_TYPE_COMMAND) y por
+// Net (mensaje binario). Todo LE:
+//   'W' ventana:  dirección (4) | bytes (4, 0 = hasta el final de la SRAM)
+//   'S' paso:     una salida cada N muestras (1, 1..255)
+//   'T' disparo:  modo (1) | nivel (1) | histéresis (1) | pre (2) | post (2)
+//   'F' filtros:  log2 de la media (1, 0..6) | alfa del IIR en Q15 (2)
+//   'M' salidas:  máscara STREAM_* (1) | FrameCodec (1, CODEC_AUTO = RateControl)
+//   'G' arranca la adquisición, 'H' la detiene, '?' solo consulta
+// Respuesta: op (1) | CommandStatus (1) | ajustes vigentes (SETTINGS_BYTES):
+//   dirección (4) | bytes (4) | paso (1) | media (1) | alfa (2) | modo (1)
+//   | nivel (1) | histéresis (1) | pre (2) | post (2) | salidas (1) | codec (1)
+//   | en marcha (1)
+enum CommandOp : uint8_t {
+    CMD_WINDOW  = 'W',
+    CMD_STRIDE  = 'S',
+    CMD_TRIGGER = 'T',
+    CMD_FILTER  = 'F',
+    CMD_STREAM  = 'M',
+    CMD_START   = 'G',
+    CMD_STOP    = 'H',
+    CMD_STATUS  = '?',
+};
+
+enum CommandStatus : uint8_t {
+    CMD_OK          = 0,
+    CMD_BAD_LENGTH  = 1,
+    CMD_BAD_VALUE   = 2,
+    CMD_UNSUPPORTED = 3, // no aplica a esta fuente de adquisición
+    CMD_UNKNOWN     = 4,
+};
+
+// Lo que sabe hacer la variante compilada
+enum CommandCaps : uint8_t {
+    CAP_WINDOW  = 1 << 0,
+    CAP_TRIGGER = 1 << 1,
+};
+
+enum StreamSink : uint8_t {
+    STREAM_UART    = 1 << 0,
+    STREAM_NET     = 1 << 1,
+    STREAM_DISPLAY = 1 << 2,
+    STREAM_UDP     = 1 << 3,
+    STREAM_ALL     = 0x0F,
+};
+
+static constexpr uint8_t CODEC_AUTO = 0xFF;
+
+// Ajustes que el host puede cambiar en marcha
+struct CaptureSettings {
+    uint32_t addr = 0;
+    uint32_t length = 0;
+    uint8_t  decimation = 1;
+    uint8_t  avgLog2 = 0;
+    int16_t  iirAlpha = 0;
+    uint8_t  trigMode = 0;        // TriggerMode
+    uint8_t  trigLevel = 128;
+    uint8_t  trigHysteresis = 4;
+    uint16_t trigPre = 64;
+    uint16_t trigPost = 448;
+    uint8_t  sinks = STREAM_ALL;
+    uint8_t  codec = CODEC_AUTO;
+    bool     running = true;
+};
+
+// Canal de comandos. handle() valida y publica los ajustes; cada etapa
+// del pipeline los toma con snapshot() entre tramas, en su propia tarea.
+// La publicación es un seqlock: un escritor (la etapa de salida, donde se
+// atienden UART y Net) y lectores en cualquier núcleo, sin bloqueos.
+class CommandChannel {
+public:
+    static constexpr size_t SETTINGS_BYTES = 22;
+    static constexpr size_t REPLY_BYTES = 2 + SETTINGS_BYTES;
+
+    // memBytes: tamaño de la SRAM para validar la ventana (0 = sin límite)
+    void begin(const CaptureSettings& initial, uint8_t caps, uint32_t memBytes = 0);
+
+    // Mismo contrato que NetMessageHook: devuelve el largo de la respuesta
+    size_t handle(const uint8_t* data, size_t len, uint8_t* reply, size_t cap);
+
+    // Copia los ajustes si cambiaron desde seen (y actualiza seen)
+    bool snapshot(CaptureSettings& out, uint32_t& seen) const;
+
+    uint32_t commands() const { return _commands; }
+    uint32_t rejected() const { return _rejected; }
+
+private:
+    CommandStatus apply(const uint8_t* data, size_t len, CaptureSettings& s) const;
+    void publish(const CaptureSettings& s);
+    static void encode(const CaptureSettings& s, uint8_t* out);
+
+    CaptureSettings _settings;    // solo la escribe publish()
+    CaptureSettings _staged;      // copia privada del escritor
+    std::atomic<uint32_t> _version{0}; // impar mientras se escribe
+    uint8_t _caps = 0;
+    uint32_t _memBytes = 0;
+    uint32_t _commands = 0;
+    uint32_t _rejected = 0;
+};
+
+#endif // COMMAND_H
@@ -0,0 +1,78 @@
+#include "decimator.h"
+
+MinMaxDecimator::MinMaxDecimator(size_t columns, uint32_t samplesPerColumn)
+    : _ring(nullptr), _columns(columns), _spc(samplesPerColumn ? samplesPerColumn : 1),
+      _head(0), _completed(0), _cur{255, 0}, _curCount(0) {}
+
+bool MinMaxDecimator::begin() {
+    if (!_ring) _ring = (Column*)malloc(_columns * sizeof(Column));
+    if (!_ring) return false;
+    reset();
+    return true;
+}
+
+void MinMaxDecimator::end() {
+    free(_ring);
+    _ring = nullptr;
+}
+
+void MinMaxDecimator::reset() {
+    if (_ring) memset(_ring, 0, _columns * sizeof(Column));
+    _head = 0;
+    _completed.store(0, std::memory_order_relaxed);
+    _cur = {255, 0};
+    _curCount = 0;
+}
+
+void MinMaxDecimator::setSamplesPerColumn(uint32_t samplesPerColumn) {
+    _spc = samplesPerColumn ? samplesPerColumn : 1;
+    reset();
+}
+
+void MinMaxDecimator::push(const uint8_t* samples, size_t len, size_t stride) {
+    if (!_ring || !samples) return;
+
+    while (len) {
+        // Tramo que cabe en la columna en curso: lazo sin cierres de columna
+        size_t n = _spc - _curCount;
+        if (n > len) n = len;
+
+        uint8_t lo = _cur.min, hi = _cur.max;
+        if (stride == 1) {
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t s = samples[i];
+                if (s < lo) lo = s;
+                if (s > hi) hi = s;
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t s = samples[i * stride];
+                if (s < lo) lo = s;
+                if (s > hi) hi = s;
+            }
+        }
+        _cur.min = lo;
+        _cur.max = hi;
+
+        _curCount += n;
+        samples += n * stride;
+        len -= n;
+        if (_curCount == _spc) closeColumn();
+    }
+}
+
+void MinMaxDecimator::closeColumn() {
+    _ring[_head] = _cur;
+    _head = (_head + 1 == _columns) ? 0 : _head + 1;
+    _completed.fetch_add(1, std::memory_order_release); // publica la columna
+    _cur = {255, 0};
+    _curCount = 0;
+}
+
+Column MinMaxDecimator::column(size_t i) const {
+    if (!_ring || i >= _columns) return {0, 0};
+    // La columna n está en n % _columns; lleno el anillo, la más antigua es
+    // completed - _columns
+    const uint32_t done = completed();
+    return columnAt((done >= _columns ? done - _columns : 0) + i);
+}
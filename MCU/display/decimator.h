@@ -0,0 +1,53 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Extremos de las muestras que caen en una columna de píxeles
+struct Column {
+    uint8_t min;
+    uint8_t max;
+};
+
+// Reductor min/max por columna para la gráfica. Cada columna guarda el
+// mínimo y el máximo de sus muestras, así que un pico de una sola muestra
+// sigue apareciendo aunque la columna cubra miles. Las columnas forman un
+// anillo: push() solo toca la columna en curso y el costo de redibujar
+// depende del ancho de pantalla, no del largo de la captura.
+// Un productor (push(), en la etapa de procesamiento) y un lector
+// (column()/completed(), en la de salida): la columna se escribe antes de
+// publicar completed(), así que todo lo que este cuenta ya está en el anillo.
+class MinMaxDecimator {
+public:
+    MinMaxDecimator(size_t columns = 240, uint32_t samplesPerColumn = 16);
+    bool begin();
+    void end();
+    void reset();
+    void setSamplesPerColumn(uint32_t samplesPerColumn); // reinicia el anillo
+
+    // len muestras tomadas cada stride bytes (canal de una trama intercalada)
+    void push(const uint8_t* samples, size_t len, size_t stride = 1);
+
+    size_t columns() const { return _columns; }
+    uint32_t samplesPerColumn() const { return _spc; }
+    // i = 0 es la columna completa más antigua, columns()-1 la más reciente
+    Column column(size_t i) const;
+    // Columna número n desde reset(); válida en [completed() - columns(), completed())
+    Column columnAt(uint32_t n) const { return _ring ? _ring[n % _columns] : Column{0, 0}; }
+    Column current() const { return _cur; } // columna en curso (parcial)
+    uint32_t completed() const { return _completed.load(std::memory_order_acquire); } // total desde reset()
+
+private:
+    void closeColumn();
+
+    Column* _ring;
+    size_t _columns;
+    uint32_t _spc;
+    size_t _head;        // siguiente posición a escribir
+    std::atomic<uint32_t> _completed;
+    Column _cur;
+    uint32_t _curCount;
+};
+
+#endif // DECIMATOR_H
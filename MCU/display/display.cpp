@@ -1,5 +1,144 @@
 #include "display.h"
 
-Display::Display() {}
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
 
-void Display::begin() {}
+Display::Display(const PanelConfig& panel)
+    : _panel(panel),
+      _decimator{MinMaxDecimator(panel.height), MinMaxDecimator(panel.height),
+                 MinMaxDecimator(panel.height), MinMaxDecimator(panel.height)},
+      _drawn(0), _fullRedraw(true) {}
+
+void Display::begin(uint32_t samplesPerColumn, uint8_t channels) {
+    _channels = (channels == 0) ? 1 : (channels > FRAME_MAX_CHANNELS ? FRAME_MAX_CHANNELS : channels);
+    for (uint8_t c = 0; c < _channels; ++c) {
+        _decimator[c].setSamplesPerColumn(samplesPerColumn);
+        _decimator[c].begin();
+    }
+
+    if (!_panel.begin()) return; // sin pantalla
+
+    const size_t bytes = (size_t)STRIP_ROWS * _panel.config().width * sizeof(uint16_t);
+    for (uint8_t i = 0; i < 2; ++i) {
+#if defined(ARDUINO_ARCH_ESP32)
+        _strip[i] = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+#else
+        _strip[i] = (uint16_t*)malloc(bytes);
+#endif
+    }
+    _fullRedraw = true;
+}
+
+void Display::update(const Frame& frame) {
+    if (frame.channels <= 1) {
+        _decimator[0].push(frame.data, frame.len);
+        return;
+    }
+    // Los canales que no se muestran se ignoran; los que faltan no avanzan.
+    // El canal 0 va al final: render() cuenta columnas con él, así que las
+    // de los demás ya están escritas cuando las ve
+    const uint8_t n = frame.channels < _channels ? frame.channels : _channels;
+    for (uint8_t c = n; c-- > 0;) {
+        _decimator[c].push(frameChannel(frame, c), frameSamples(frame), frameStride(frame));
+    }
+}
+
+void Display::setSamplesPerColumn(uint32_t samplesPerColumn) {
+    for (uint8_t c = 0; c < _channels; ++c) _decimator[c].setSamplesPerColumn(samplesPerColumn);
+    _fullRedraw = true;
+}
+
+size_t Display::render() {
+    if (!_panel.ready() || !_strip[0] || !_strip[1]) return 0;
+    TRACE_SCOPE(TRACE_DISPLAY, 0);
+
+    const uint32_t completed = _decimator[0].completed();
+    const uint32_t height = _panel.config().height;
+
+    // Si cambió el zoom o hay más columnas nuevas que filas, va todo el anillo
+    if (_fullRedraw || completed < _drawn || completed - _drawn > height) {
+        _fullRedraw = false;
+        _drawn = (completed > height) ? completed - height : 0;
+        if (completed < height) {
+            // Filas todavía sin columna: se borran una vez
+            for (uint32_t r = completed; r < height; r += STRIP_ROWS) {
+                uint8_t b = _stripNext;
+                _stripNext ^= 1;
+                _panel.wait(_stripTicket[b]);
+                const uint16_t rows = (height - r < STRIP_ROWS) ? height - r : STRIP_ROWS;
+                const size_t px = (size_t)rows * _panel.config().width;
+                for (size_t i = 0; i < px; ++i) _strip[b][i] = COLOR_BG;
+                _stripTicket[b] = _panel.pushRows(r, rows, _strip[b]);
+            }
+        }
+    }
+
+    const uint32_t fresh = completed - _drawn;
+    if (fresh == 0) return 0;
+
+    size_t drawn = pushColumns(_drawn, fresh);
+    _drawn = completed;
+
+    // La columna más antigua queda a la izquierda (arriba en memoria)
+    if (completed >= height) _panel.setScroll(completed % height);
+    return drawn;
+}
+
+size_t Display::pushColumns(uint32_t first, uint32_t count) {
+    const uint16_t width = _panel.config().width;
+    const uint32_t height = _panel.config().height;
+    const uint32_t oldest = (first + count > height) ? first + count - height : 0;
+
+    size_t drawn = 0;
+    while (count) {
+        // Tira de filas contiguas en memoria del panel (sin dar la vuelta)
+        const uint16_t row = first % height;
+        uint32_t rows = STRIP_ROWS;
+        if (rows > count) rows = count;
+        if (rows > height - row) rows = height - row;
+
+        const uint8_t b = _stripNext;
+        _stripNext ^= 1;
+        _panel.wait(_stripTicket[b]); // la tira se reutiliza cuando el DMA la soltó
+
+        for (uint32_t i = 0; i < rows; ++i) {
+            const uint32_t n = first + i;
+            uint16_t* line = _strip[b] + (size_t)i * width;
+            clearRow(line);
+            for (uint8_t ch = 0; ch < _channels; ++ch) {
+                const MinMaxDecimator& d = _decimator[ch];
+                const Column c = d.columnAt(n);
+                const Column prev = (n > oldest) ? d.columnAt(n - 1) : c;
+                drawTrace(line, c, prev, COLOR_TRACE[ch]);
+            }
+        }
+        _stripTicket[b] = _panel.pushRows(row, rows, _strip[b]);
+
+        first += rows;
+        count -= rows;
+        drawn += rows;
+    }
+    return drawn;
+}
+
+void Display::clearRow(uint16_t* row) const {
+    const uint16_t width = _panel.config().width;
+    for (uint16_t y = 0; y < width; ++y) row[y] = COLOR_BG;
+    // Rejilla horizontal cada cuarto de escala
+    for (uint16_t q = 1; q < 4; ++q) row[q * width / 4] = COLOR_GRID;
+}
+
+void Display::drawTrace(uint16_t* row, Column c, Column prev, uint16_t color) const {
+    const uint16_t width = _panel.config().width;
+
+    // Se une con la columna anterior para que la traza no quede cortada
+    uint8_t lo = c.min, hi = c.max;
+    if (lo > prev.max) lo = prev.max;
+    if (hi < prev.min) hi = prev.min;
+
+    const uint16_t y0 = (uint32_t)lo * (width - 1) / 255;
+    const uint16_t y1 = (uint32_t)hi * (width - 1) / 255;
+
+    for (uint16_t y = y0; y <= y1; ++y) row[y] = color;
+}
@@ -1,10 +1,55 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <Arduino.h>
+#include "../trace/trace.h"
+#include "decimator.h"
+#include "panel.h"
+#include "../frame_pool/frame_pool.h"
+
+// Gráfica de intensidad en el tiempo. Cada columna del reductor min/max es
+// una fila de memoria del panel; al llegar columnas nuevas solo se dibujan
+// esas (región sucia) en una tira de pocas filas y el eje de tiempo avanza
+// con el scroll por hardware, sin redibujar la pantalla. Dos tiras se
+// alternan: mientras el DMA envía una, la CPU pinta la otra.
+// Con varios canales cada uno tiene su reductor y se superponen en la
+// misma columna, cada uno con su color.
 class Display {
 public:
-    Display();
-    void begin();
+    Display(const PanelConfig& panel = PanelConfig());
+    void begin(uint32_t samplesPerColumn = 16, uint8_t channels = 1);
+
+    // Alimenta la gráfica con una trama del pipeline (hasta channels canales)
+    void update(const Frame& frame);
+    // Envía al panel las columnas nuevas; devuelve cuántas dibujó
+    size_t render();
+    void invalidate() { _fullRedraw = true; } // redibujar todo en el próximo render()
+    void setSamplesPerColumn(uint32_t samplesPerColumn);
+
+    MinMaxDecimator& decimator(uint8_t channel = 0) { return _decimator[channel]; }
+    uint8_t channels() const { return _channels; }
+    bool hasPanel() const { return _panel.ready(); }
+
+private:
+    static constexpr uint16_t STRIP_ROWS = 8;
+    // RGB565 con los bytes ya invertidos (el panel espera big-endian)
+    static constexpr uint16_t COLOR_BG    = 0x0000;
+    static constexpr uint16_t COLOR_GRID  = 0x0842; // gris 0x4208
+    // verde 0x07E0, amarillo 0xFFE0, cian 0x07FF, magenta 0xF81F
+    static constexpr uint16_t COLOR_TRACE[FRAME_MAX_CHANNELS] = {0xE007, 0xE0FF, 0xFF07, 0x1FF8};
+
+    void clearRow(uint16_t* row) const;
+    void drawTrace(uint16_t* row, Column c, Column prev, uint16_t color) const;
+    size_t pushColumns(uint32_t first, uint32_t count);
+
+    Panel _panel;
+    MinMaxDecimator _decimator[FRAME_MAX_CHANNELS];
+    uint8_t _channels = 1;
+    uint16_t* _strip[2] = {nullptr, nullptr};
+    uint32_t _stripTicket[2] = {0, 0};
+    uint8_t _stripNext = 0;
+    uint32_t _drawn;      // columnas ya enviadas (en la numeración de completed())
+    bool _fullRedraw;
 };
 
 #endif // DISPLAY_H
@@ -0,0 +1,183 @@
+#include "panel.h"
+
+Panel::Panel(const PanelConfig& cfg)
+    : _cfg(cfg), _ready(false), _queued(0), _done(0),
+      _host(SpiBus::host(SPI_ROLE_UI)) {}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+bool Panel::begin() {
+    if (_ready) return true;
+    if (_cfg.pinCS < 0 || _cfg.pinDC < 0 || _cfg.pinSCK < 0 || _cfg.pinMOSI < 0) return false;
+
+    pinMode(_cfg.pinDC, OUTPUT);
+    if (_cfg.pinRST >= 0) {
+        pinMode(_cfg.pinRST, OUTPUT);
+        digitalWrite(_cfg.pinRST, LOW);
+        delay(10);
+        digitalWrite(_cfg.pinRST, HIGH);
+        delay(120);
+    }
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = _cfg.pinMOSI;
+    bus.miso_io_num = -1;
+    bus.sclk_io_num = _cfg.pinSCK;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = 32768;
+
+    spi_device_interface_config_t dev = {};
+    dev.mode = 0;
+    dev.clock_speed_hz = _cfg.clockHz;
+    dev.spics_io_num = _cfg.pinCS;
+    dev.queue_size = TRANS_SLOTS;
+    dev.pre_cb = preTransfer;
+    dev.flags = SPI_DEVICE_NO_DUMMY;
+
+    if (!SpiBus::attach(_host, bus)) return false;
+    if (spi_bus_add_device(_host, &dev, &_dev) != ESP_OK) {
+        SpiBus::detach(_host);
+        return false;
+    }
+    SpiBus::addDevice(_host);
+    _ready = true;
+
+    command(CMD_SWRESET);
+    waitIdle();
+    delay(120);
+    command(CMD_SLPOUT);
+    waitIdle();
+    delay(120);
+
+    const uint8_t colmod = 0x55; // RGB565
+    command(CMD_COLMOD);
+    data(&colmod, 1);
+    const uint8_t madctl = 0x08; // orientación nativa, orden BGR
+    command(CMD_MADCTL);
+    data(&madctl, 1);
+
+    // Toda la memoria es zona de scroll vertical (sin franjas fijas)
+    uint8_t vscrdef[6] = {0, 0, (uint8_t)(_cfg.height >> 8), (uint8_t)_cfg.height, 0, 0};
+    command(CMD_VSCRDEF);
+    data(vscrdef, sizeof(vscrdef));
+
+    command(CMD_DISPON);
+    waitIdle();
+    return true;
+}
+
+void IRAM_ATTR Panel::preTransfer(spi_transaction_t* t) {
+    // user = pin DC | nivel << 8
+    const uint32_t u = (uint32_t)(uintptr_t)t->user;
+    gpio_set_level((gpio_num_t)(u & 0xFF), u >> 8);
+}
+
+spi_transaction_t* Panel::nextTrans() {
+    // El anillo de transacciones tiene el tamaño de la cola del driver
+    if (_queued - _done >= TRANS_SLOTS) collect(true);
+    spi_transaction_t* t = &_trans[_queued % TRANS_SLOTS];
+    memset(t, 0, sizeof(*t));
+    return t;
+}
+
+void Panel::collect(bool block) {
+    spi_transaction_t* t = nullptr;
+    while (_done < _queued &&
+           spi_device_get_trans_result(_dev, &t, block ? portMAX_DELAY : 0) == ESP_OK) {
+        ++_done;
+        block = false; // con una basta para liberar sitio
+    }
+}
+
+void Panel::command(uint8_t cmd) {
+    spi_transaction_t* t = nextTrans();
+    t->flags = SPI_TRANS_USE_TXDATA;
+    t->length = 8;
+    t->tx_data[0] = cmd;
+    t->user = (void*)(uintptr_t)(_cfg.pinDC | (0 << 8));
+    spi_device_queue_trans(_dev, t, portMAX_DELAY);
+    ++_queued;
+}
+
+void Panel::data(const void* bytes, size_t len) {
+    if (len == 0) return;
+    spi_transaction_t* t = nextTrans();
+    if (len <= 4) {
+        t->flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t->tx_data, bytes, len);
+    } else {
+        t->tx_buffer = bytes; // debe seguir válido hasta completarse
+    }
+    t->length = len * 8;
+    t->user = (void*)(uintptr_t)(_cfg.pinDC | (1 << 8));
+    spi_device_queue_trans(_dev, t, portMAX_DELAY);
+    ++_queued;
+}
+
+void Panel::data16(uint16_t a, uint16_t b) {
+    const uint8_t bytes[4] = {(uint8_t)(a >> 8), (uint8_t)a, (uint8_t)(b >> 8), (uint8_t)b};
+    data(bytes, sizeof(bytes)); // va en tx_data: se copia
+}
+
+uint32_t Panel::pushRows(uint16_t row, uint16_t rows, const uint16_t* pixels) {
+    if (!_ready || rows == 0) return _queued;
+    // Una ráfaga de 6 transacciones; cede el host a la adquisición si lo
+    // comparten. En ese caso el bus se retiene hasta que termine el DMA de
+    // las filas: si no, la adquisición "prioritaria" esperaría en la cola
+    // del driver detrás de la ráfaga ya encolada
+    SpiLock lock(_host, SPI_PRIO_LOW);
+    command(CMD_CASET);
+    data16(0, _cfg.width - 1);
+    command(CMD_RASET);
+    data16(row, row + rows - 1);
+    command(CMD_RAMWR);
+    data(pixels, (size_t)rows * _cfg.width * sizeof(uint16_t));
+    if (SpiBus::shared(_host)) wait(_queued);
+    else collect(false);
+    return _queued;
+}
+
+void Panel::setScroll(uint16_t row) {
+    if (!_ready) return;
+    const uint8_t bytes[2] = {(uint8_t)(row >> 8), (uint8_t)row};
+    SpiLock lock(_host, SPI_PRIO_LOW);
+    command(CMD_VSCRSADD);
+    data(bytes, sizeof(bytes));
+    if (SpiBus::shared(_host)) wait(_queued); // como pushRows(): terminada antes de soltar el bus
+}
+
+void Panel::wait(uint32_t ticket) {
+    while (_ready && (int32_t)(_done - ticket) < 0) collect(true);
+}
+
+void Panel::waitIdle() {
+    wait(_queued);
+}
+
+#elif defined(PANEL_HEADLESS)
+
+// Banco en el PC: las filas se aceptan y se descartan, así render() hace
+// todo el trabajo de CPU (tiras, trazos) sin hardware
+bool Panel::begin() { _ready = true; return true; }
+uint32_t Panel::pushRows(uint16_t, uint16_t, const uint16_t*) { _done = ++_queued; return _queued; }
+void Panel::setScroll(uint16_t) {}
+void Panel::wait(uint32_t) {}
+void Panel::waitIdle() {}
+void Panel::command(uint8_t) {}
+void Panel::data(const void*, size_t) {}
+void Panel::data16(uint16_t, uint16_t) {}
+
+#else
+
+// Sin ESP32 no hay panel: el Display funciona sin pantalla
+bool Panel::begin() { return false; }
+uint32_t Panel::pushRows(uint16_t, uint16_t, const uint16_t*) { return 0; }
+void Panel::setScroll(uint16_t) {}
+void Panel::wait(uint32_t) {}
+void Panel::waitIdle() {}
+void Panel::command(uint8_t) {}
+void Panel::data(const void*, size_t) {}
+void Panel::data16(uint16_t, uint16_t) {}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+#include <Arduino.h>
+#include "../spi_bus/spi_bus.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/spi_master.h>
+#include <driver/gpio.h>
+#endif
+
+// Pines y geometría del panel. Sin CS/DC el Display queda sin pantalla
+// (solo se actualiza el reductor), útil en bancos sin TFT.
+struct PanelConfig {
+    int8_t pinCS   = -1;
+    int8_t pinDC   = -1;
+    int8_t pinRST  = -1;
+    int8_t pinSCK  = -1;
+    int8_t pinMOSI = -1;
+    uint16_t width  = 240; // píxeles por fila de memoria (alto de la gráfica)
+    uint16_t height = 320; // filas de memoria (eje de tiempo, con scroll por hardware)
+    uint32_t clockHz = 40'000'000;
+};
+
+// Panel RGB565 tipo ILI9341/ST7789 en el host de SPI_ROLE_UI (no el de la SRAM).
+// Todas las transferencias van encoladas al driver de IDF con DMA: pushRows()
+// vuelve enseguida y el búfer de píxeles debe seguir válido hasta que
+// wait() confirme su ticket. Si el host se comparte con la SRAM, cada
+// ráfaga retiene el bus hasta completarse (pushRows() ya no solapa el DMA
+// con el dibujo): así la adquisición espera como mucho una ráfaga.
+class Panel {
+public:
+    Panel(const PanelConfig& cfg = PanelConfig());
+    bool begin();
+    bool ready() const { return _ready; }
+    const PanelConfig& config() const { return _cfg; }
+
+    // Escribe filas completas [row, row + rows); devuelve un ticket para wait()
+    uint32_t pushRows(uint16_t row, uint16_t rows, const uint16_t* pixels);
+    void setScroll(uint16_t row); // primera fila de memoria que se ve arriba
+    void wait(uint32_t ticket);   // bloquea hasta completar ese ticket
+    void waitIdle();
+
+private:
+    static constexpr uint8_t CMD_SWRESET  = 0x01;
+    static constexpr uint8_t CMD_SLPOUT   = 0x11;
+    static constexpr uint8_t CMD_DISPON   = 0x29;
+    static constexpr uint8_t CMD_CASET    = 0x2A;
+    static constexpr uint8_t CMD_RASET    = 0x2B;
+    static constexpr uint8_t CMD_RAMWR    = 0x2C;
+    static constexpr uint8_t CMD_VSCRDEF  = 0x33;
+    static constexpr uint8_t CMD_MADCTL   = 0x36;
+    static constexpr uint8_t CMD_VSCRSADD = 0x37;
+    static constexpr uint8_t CMD_COLMOD   = 0x3A;
+
+    void command(uint8_t cmd);
+    void data(const void* bytes, size_t len);
+    void data16(uint16_t a, uint16_t b);
+
+    PanelConfig _cfg;
+    bool _ready;
+    uint32_t _queued; // transacciones encoladas desde begin()
+    uint32_t _done;   // transacciones completadas
+    SpiHost _host;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr size_t TRANS_SLOTS = 16;
+    static void IRAM_ATTR preTransfer(spi_transaction_t* t);
+    spi_transaction_t* nextTrans();
+    void collect(bool block);
+    spi_device_handle_t _dev = nullptr;
+    spi_transaction_t _trans[TRANS_SLOTS];
+#endif
+};
+
+#endif // PANEL_H
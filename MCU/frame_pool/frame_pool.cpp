@@ -0,0 +1,123 @@
+#include "frame_pool.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+FramePool::FramePool()
+    : _storage(nullptr), _count(0), _frameBytes(0), _freeMask(0) {}
+
+bool FramePool::begin(size_t count, size_t frameBytes) {
+    if (_storage || count == 0 || count > MAX_FRAMES || frameBytes == 0) return false;
+    if (frameBytes > UINT16_MAX) return false;
+
+    // Múltiplo de 4: el DMA del SPI trabaja con palabras alineadas
+    const size_t stride = (frameBytes + 3) & ~(size_t)3;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    _storage = (uint8_t*)heap_caps_malloc(count * stride, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#else
+    _storage = (uint8_t*)malloc(count * stride);
+#endif
+    if (!_storage) return false;
+
+    for (size_t i = 0; i < count; ++i) {
+        Frame& f = _frames[i];
+        f.seq = 0;
+        f.addr = 0;
+        f.stamp = 0;
+        f.len = 0;
+        f.codec = 0;
+        f.channels = 1;
+        f.layout = FRAME_INTERLEAVED;
+        f.capacity = frameBytes;
+        f.data = _storage + i * stride;
+        f.refs.store(0, std::memory_order_relaxed);
+        f.index = i;
+    }
+
+    _count = count;
+    _frameBytes = frameBytes;
+    _freeMask.store((count == 32) ? 0xFFFFFFFFu : ((1u << count) - 1), std::memory_order_release);
+    return true;
+}
+
+void FramePool::end() {
+    _freeMask.store(0, std::memory_order_release);
+    free(_storage);
+    _storage = nullptr;
+    _count = 0;
+}
+
+Frame* FramePool::acquire() {
+    uint32_t mask = _freeMask.load(std::memory_order_acquire);
+    while (mask) {
+        const uint32_t bit = mask & (~mask + 1); // bit libre más bajo
+        if (_freeMask.compare_exchange_weak(mask, mask & ~bit,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+            Frame* f = &_frames[__builtin_ctz(bit)];
+            f->refs.store(1, std::memory_order_relaxed);
+            f->len = 0;
+            f->codec = 0;
+            f->channels = 1;
+            f->layout = FRAME_INTERLEAVED;
+            return f;
+        }
+        // compare_exchange actualizó mask: se reintenta
+    }
+    return nullptr;
+}
+
+void FramePool::retain(Frame* frame) {
+    if (frame) frame->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePool::release(Frame* frame) {
+    if (!frame) return;
+    if (frame->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        _freeMask.fetch_or(1u << frame->index, std::memory_order_release);
+    }
+}
+
+size_t FramePool::available() const {
+    return __builtin_popcount(_freeMask.load(std::memory_order_acquire));
+}
+
+void deinterleave(const uint8_t* src, size_t len, uint8_t channels, uint8_t* dst) {
+    const size_t n = len / channels;
+    size_t i = 0;
+
+    // 2 y 4 canales: palabras de 32 bits en lugar de bytes sueltos
+    if (channels == 2) {
+        uint8_t* a = dst;
+        uint8_t* b = dst + n;
+        for (; i + 4 <= n; i += 4) {
+            uint32_t w0, w1;
+            memcpy(&w0, src + 2 * i, 4);     // a0 b0 a1 b1 (LE)
+            memcpy(&w1, src + 2 * i + 4, 4); // a2 b2 a3 b3
+            const uint32_t wa = (w0 & 0xFF) | ((w0 >> 8) & 0xFF00) |
+                                ((w1 & 0xFF) << 16) | ((w1 << 8) & 0xFF000000u);
+            const uint32_t wb = ((w0 >> 8) & 0xFF) | ((w0 >> 16) & 0xFF00) |
+                                ((w1 << 8) & 0xFF0000) | (w1 & 0xFF000000u);
+            memcpy(a + i, &wa, 4);
+            memcpy(b + i, &wb, 4);
+        }
+    } else if (channels == 4) {
+        for (; i + 4 <= n; i += 4) {
+            // Trasposición 4x4 de bytes: palabra k = muestra k de los 4 canales
+            uint32_t w[4];
+            memcpy(w, src + 4 * i, 16);
+            for (uint8_t c = 0; c < 4; ++c) {
+                const uint8_t sh = 8 * c;
+                const uint32_t v = ((w[0] >> sh) & 0xFF) | (((w[1] >> sh) & 0xFF) << 8) |
+                                   (((w[2] >> sh) & 0xFF) << 16) | (((w[3] >> sh) & 0xFF) << 24);
+                memcpy(dst + c * n + i, &v, 4);
+            }
+        }
+    }
+
+    for (; i < n; ++i) {
+        for (uint8_t c = 0; c < channels; ++c) dst[c * n + i] = src[i * channels + c];
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Bytes de muestra por trama (por defecto)
+static constexpr size_t FRAME_BYTES = 512;
+static constexpr uint8_t FRAME_MAX_CHANNELS = 4;
+
+// Orden de las muestras con varios canales
+enum FrameLayout : uint8_t {
+    FRAME_INTERLEAVED = 0, // c0 c1 .. cN-1 c0 c1 ..., como están en la SRAM
+    FRAME_PLANAR      = 1, // un tramo contiguo por canal (lazos sin paso)
+};
+
+// Trama de muestras que recorre el pipeline. Los datos viven en el pool y
+// se pasan de una etapa a otra por puntero, sin copiar.
+struct Frame {
+    uint32_t seq;      // número de secuencia desde el arranque
+    uint32_t addr;     // dirección de origen en la SRAM
+    uint32_t stamp;    // Peripherals::cycles() al completarse la trama en la fuente
+    uint16_t len;      // bytes válidos en data
+    uint16_t capacity; // tamaño de data
+    uint8_t codec;     // FrameCodec de data (0 = muestras crudas)
+    uint8_t channels;  // canales en data (1..FRAME_MAX_CHANNELS); len es el total
+    uint8_t layout;    // FrameLayout
+    uint8_t* data;     // RAM interna apta para DMA
+    std::atomic<uint8_t> refs;
+    uint8_t index;     // posición en el pool
+};
+
+// Muestras por canal, comienzo y paso del canal ch
+inline size_t frameSamples(const Frame& f) { return f.len / f.channels; }
+inline size_t frameStride(const Frame& f) { return f.layout == FRAME_PLANAR ? 1 : f.channels; }
+inline const uint8_t* frameChannel(const Frame& f, uint8_t ch) {
+    return f.layout == FRAME_PLANAR ? f.data + ch * frameSamples(f) : f.data + ch;
+}
+
+// Byte de formato hacia el host: FrameCodec (bits 0-3) | canales - 1 (4-6) |
+// planar (7). Con un canal coincide con el codec solo.
+inline uint8_t frameFormat(const Frame& f) {
+    return (uint8_t)((f.layout == FRAME_PLANAR ? 0x80 : 0) | ((f.channels - 1) & 0x07) << 4 | (f.codec & 0x0F));
+}
+
+// Separa len bytes intercalados de channels canales en planos contiguos
+// (dst no puede solapar src). len debe ser múltiplo de channels.
+void deinterleave(const uint8_t* src, size_t len, uint8_t channels, uint8_t* dst);
+
+// Pool de tramas de tamaño fijo con cuenta de referencias.
+// Toda la memoria se reserva en begin() (RAM interna con capacidad DMA), así
+// que en marcha no hay malloc/new ni fragmentación. acquire() y release()
+// no usan bloqueos y se pueden llamar desde cualquier tarea o núcleo.
+class FramePool {
+public:
+    static constexpr size_t MAX_FRAMES = 32; // un bit por trama en _freeMask
+
+    FramePool();
+    bool begin(size_t count, size_t frameBytes = FRAME_BYTES);
+    void end();
+
+    Frame* acquire();           // refs = 1; nullptr si no quedan
+    void retain(Frame* frame);  // otra etapa más comparte la trama
+    void release(Frame* frame); // al llegar a 0 vuelve al pool
+
+    size_t available() const;
+    size_t capacity() const { return _count; }
+    size_t frameBytes() const { return _frameBytes; }
+
+private:
+    Frame _frames[MAX_FRAMES];
+    uint8_t* _storage;
+    size_t _count;
+    size_t _frameBytes;
+    std::atomic<uint32_t> _freeMask; // bit i = trama i libre
+};
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,112 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Núcleo Arduino mínimo para compilar los módulos en el PC (ver Makefile).
+// Solo lo que usan las ramas sin ARDUINO_ARCH_ESP32; el reloj es el real
+// del host para que las mediciones con micros() tengan sentido.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define DEC 10
+#define HEX 16
+#define IRAM_ATTR
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Pines: solo el CS de la SRAM simulada hace algo (ver SPI.h)
+inline void pinMode(int, int) {}
+void digitalWrite(int pin, int value);
+inline int digitalRead(int) { return LOW; }
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// Tiempo de pared del host
+unsigned long millis();
+unsigned long micros();
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int) {}
+inline void yield() {}
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t* buffer, size_t size) { return size; }
+    size_t print(const char* s) { return printf("%s", s); }
+    size_t print(char c) { return printf("%c", c); }
+    size_t print(int v, int base = DEC) { return printf(base == HEX ? "%x" : "%d", v); }
+    size_t print(unsigned v, int base = DEC) { return printf(base == HEX ? "%x" : "%u", v); }
+    size_t print(long v, int base = DEC) { return printf(base == HEX ? "%lx" : "%ld", v); }
+    size_t print(unsigned long v, int base = DEC) { return printf(base == HEX ? "%lx" : "%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println(const char* s = "") { return printf("%s\n", s); }
+    size_t println(int v, int base = DEC) { return print(v, base) + println(); }
+    size_t println(unsigned v, int base = DEC) { return print(v, base) + println(); }
+    size_t println(long v, int base = DEC) { return print(v, base) + println(); }
+    size_t println(unsigned long v, int base = DEC) { return print(v, base) + println(); }
+    size_t println(double v, int digits = 2) { return print(v, digits) + println(); }
+    virtual size_t printf(const char*, ...) { return 0; }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    size_t readBytes(uint8_t*, size_t) { return 0; }
+    void setTimeout(unsigned long) {}
+};
+
+// Puerto serie del host: lo escrito se cuenta y se resume en un hash
+// (FNV-1a) para comparar corridas; no llega nada por RX.
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long, uint32_t = 0, int8_t = -1, int8_t = -1) {}
+    void end() {}
+    size_t setRxBufferSize(size_t n) { return n; }
+    size_t setTxBufferSize(size_t n) { return n; }
+    int availableForWrite() { return 1 << 20; } // el host nunca llena el anillo
+    void flush() {}
+    operator bool() const { return true; }
+
+    using Print::write;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    size_t printf(const char* fmt, ...) override;
+
+    // Del lado del simulador
+    void echo(bool on) { _echo = on; } // texto de print() a stdout
+    uint64_t txBytes() const { return _txBytes; }
+    uint64_t txHash() const { return _txHash; }
+
+private:
+    bool _echo = true;
+    uint64_t _txBytes = 0;
+    uint64_t _txHash = 0xcbf29ce484222325ULL;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif // HOST_ARDUINO_H
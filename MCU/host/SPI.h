@@ -0,0 +1,98 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+struct SPISettings {
+    SPISettings(uint32_t = 0, uint8_t = 0, uint8_t = 0) {}
+};
+
+// SRAM serie simulada (tipo 23LC1024: 3 bytes de dirección, modo
+// secuencial) con el contenido de una captura grabada. La capacidad es una
+// potencia de dos para que RamReader::detectGeometry() la deduzca por el
+// punto donde las direcciones se repiten. Entiende READ, FAST_READ, WRITE
+// y WRMR; cualquier otro comando se ignora hasta soltar CS.
+class HostSram {
+public:
+    bool begin(size_t sizeBytes, int8_t pinCS);
+    void end();
+    // Copia la captura desde la dirección 0 y la repite hasta llenar la
+    // memoria; devuelve los bytes leídos del archivo (0 = error)
+    size_t load(const char* path);
+    void fill(const uint8_t* data, size_t len);
+
+    int8_t pinCS() const { return _pinCS; }
+    size_t size() const { return _mask + 1; }
+    uint64_t busBytes() const { return _busBytes; } // bytes clockeados desde begin()
+
+    void select(bool low);
+    uint8_t transfer(uint8_t out) {
+        ++_busBytes;
+        switch (_state) {
+            case IDLE:
+                return 0;
+            case COMMAND:
+                _cmd = out;
+                _addr = 0;
+                _addrLeft = ADDR_BYTES;
+                _state = (_cmd == CMD_READ || _cmd == CMD_FAST_READ || _cmd == CMD_WRITE) ? ADDRESS : IDLE;
+                return 0;
+            case ADDRESS:
+                _addr = (_addr << 8) | out;
+                if (--_addrLeft == 0) _state = (_cmd == CMD_FAST_READ) ? DUMMY : DATA;
+                return 0;
+            case DUMMY:
+                _state = DATA;
+                return 0;
+            case DATA: {
+                uint8_t& cell = _mem[_addr++ & _mask];
+                if (_cmd == CMD_WRITE) { cell = out; return 0; }
+                return cell;
+            }
+        }
+        return 0;
+    }
+
+private:
+    enum State : uint8_t { IDLE, COMMAND, ADDRESS, DUMMY, DATA };
+    static constexpr uint8_t CMD_READ = 0x03;
+    static constexpr uint8_t CMD_FAST_READ = 0x0B;
+    static constexpr uint8_t CMD_WRITE = 0x02;
+    static constexpr uint8_t ADDR_BYTES = 3;
+
+    uint8_t* _mem = nullptr;
+    uint32_t _mask = 0;
+    int8_t _pinCS = -1;
+    State _state = IDLE;
+    uint8_t _cmd = 0;
+    uint8_t _addrLeft = 0;
+    uint32_t _addr = 0;
+    uint64_t _busBytes = 0;
+};
+
+extern HostSram sram;
+
+class SPIClass {
+public:
+    SPIClass(uint8_t = 0) {}
+    void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    void setFrequency(uint32_t) {}
+    uint8_t transfer(uint8_t out) { return sram.transfer(out); }
+    void transferBytes(const uint8_t* out, uint8_t* in, uint32_t n) {
+        for (uint32_t i = 0; i < n; ++i) {
+            const uint8_t r = sram.transfer(out ? out[i] : 0);
+            if (in) in[i] = r;
+        }
+    }
+    void writeBytes(const uint8_t* out, uint32_t n) { transferBytes(out, nullptr, n); }
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
@@ -0,0 +1,87 @@
+#include "Arduino.h"
+#include "SPI.h"
+#include <stdarg.h>
+#include <chrono>
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+SPIClass SPI;
+HostSram sram;
+
+static const auto hostStart = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+
+void digitalWrite(int pin, int value) {
+    if (pin == sram.pinCS()) sram.select(value == LOW);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        _txHash ^= buffer[i];
+        _txHash *= 0x100000001b3ULL;
+    }
+    _txBytes += size;
+    return size;
+}
+
+size_t HardwareSerial::printf(const char* fmt, ...) {
+    if (!_echo) return 0;
+    va_list args;
+    va_start(args, fmt);
+    const int n = vprintf(fmt, args);
+    va_end(args);
+    return n < 0 ? 0 : (size_t)n;
+}
+
+bool HostSram::begin(size_t sizeBytes, int8_t pinCS) {
+    // Potencia de dos entre 1 KiB y 16 MiB (3 bytes de dirección)
+    size_t size = 1024;
+    while (size < sizeBytes && size < ((size_t)1 << 24)) size <<= 1;
+    end();
+    _mem = (uint8_t*)calloc(size, 1);
+    if (!_mem) return false;
+    _mask = (uint32_t)(size - 1);
+    _pinCS = pinCS;
+    _state = IDLE;
+    _busBytes = 0;
+    return true;
+}
+
+void HostSram::end() {
+    free(_mem);
+    _mem = nullptr;
+    _mask = 0;
+}
+
+void HostSram::select(bool low) {
+    _state = low ? COMMAND : IDLE;
+}
+
+void HostSram::fill(const uint8_t* data, size_t len) {
+    if (!_mem || !data || len == 0) return;
+    for (size_t off = 0; off < size(); off += len) {
+        const size_t n = (size() - off < len) ? size() - off : len;
+        memcpy(_mem + off, data, n);
+    }
+}
+
+size_t HostSram::load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    uint8_t* data = (uint8_t*)malloc(size());
+    const size_t n = data ? fread(data, 1, size(), f) : 0;
+    fclose(f);
+    fill(data, n);
+    free(data);
+    return n;
+}
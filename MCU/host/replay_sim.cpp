@@ -0,0 +1,363 @@
+// Simulador en el PC: el pipeline completo (RamReader -> SramSource -> Pds,
+// Spectrum, Pyramid -> Display sin pantalla, Compressor, UartComm, Net)
+// sobre una SRAM simulada cargada con una captura grabada. Corre lo más
+// rápido que puede y mide cada etapa, para ver regresiones de rendimiento
+// antes de grabar la placa. Uso: ver usage() o el Makefile.
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <chrono>
+#include "../ram_reader/ram_reader.h"
+#include "../frame_pool/frame_pool.h"
+#include "../source/sram_source.h"
+#include "../pipeline/pipeline.h"
+#include "../pds/pds.h"
+#include "../pds/spectrum.h"
+#include "../pds/pyramid.h"
+#include "../display/display.h"
+#include "../codec/codec.h"
+#include "../uart_comm/uart_comm.h"
+#include "../net/net.h"
+#include "../stages/stages.h"
+
+static constexpr int8_t SRAM_CS = 5; // el mismo pin que en MCU.ino
+static constexpr double MIN_SLOWDOWN_NS = 50;
+
+static uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Tiempo acumulado de una etapa; bytes = muestras crudas que le entraron
+struct StageTimer {
+    const char* name;
+    uint8_t depth; // sangría en el informe: 1 = parte de la etapa de arriba
+    uint64_t ns;
+    uint64_t frames;
+    uint64_t bytes;
+};
+
+enum Stage : uint8_t {
+    ST_ACQUIRE, ST_PROCESS, ST_SPECTRUM, ST_DISPLAY_UPDATE, ST_PDS, ST_PYRAMID,
+    ST_OUTPUT, ST_DISPLAY_RENDER, ST_CODEC, ST_UART, ST_NET,
+    ST_COUNT
+};
+
+static StageTimer stages[ST_COUNT] = {
+    {"acquire", 0, 0, 0, 0},
+    {"process", 0, 0, 0, 0},
+    {"spectrum", 1, 0, 0, 0},
+    {"display.update", 1, 0, 0, 0},
+    {"pds", 1, 0, 0, 0},
+    {"pyramid", 1, 0, 0, 0},
+    {"output", 0, 0, 0, 0},
+    {"display.render", 1, 0, 0, 0},
+    {"codec", 1, 0, 0, 0},
+    {"uart", 1, 0, 0, 0},
+    {"net", 1, 0, 0, 0},
+};
+
+static void account(Stage s, uint64_t t0, size_t bytes = 0) {
+    stages[s].ns += nowNs() - t0;
+    ++stages[s].frames;
+    stages[s].bytes += bytes;
+}
+
+struct SimConfig {
+    const char* capture = nullptr; // nullptr = señal sintética
+    uint32_t frames = 20000;
+    size_t frameLen = FRAME_BYTES;
+    uint8_t channels = 1;
+    size_t sramBytes = 128 * 1024;
+    FrameCodec codec = CODEC_DELTA_PACK;
+    const char* results = nullptr;
+    const char* baseline = nullptr;
+    double tolerance = 15.0; // % de ns/trama por encima de la referencia
+};
+
+static SimConfig sim;
+
+static RamReader* ram;
+static FramePool pool;
+static SramSource* source;
+static Pipeline<SramSource>* pipeline;
+static Pds pds;
+static Spectrum<256> spectrum;
+static Pyramid pyramid;
+static Display display; // sin pines: con PANEL_HEADLESS dibuja y descarta
+static Compressor compressor(CODEC_DELTA_PACK);
+static UartComm uartComm;
+static Net net(pool);
+static uint64_t pdsHash = 0xcbf29ce484222325ULL;
+
+static void hashBytes(uint64_t& h, const uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+}
+
+static FrameStages<Spectrum<256>> frameStages(pds, spectrum, pyramid, display, compressor, uartComm, net);
+
+// Temporizador de cada parte de FrameStages
+static constexpr Stage STAGE_TIMER[FRAME_STAGES] = {
+    ST_SPECTRUM, ST_DISPLAY_UPDATE, ST_PDS, ST_PYRAMID,
+    ST_CODEC, ST_UART, ST_NET, ST_DISPLAY_RENDER,
+};
+static uint64_t stageStart;
+
+static void probeStage(FrameStage stage, bool done, const Frame& frame, size_t raw) {
+    if (!done) {
+        stageStart = nowNs();
+        return;
+    }
+    account(STAGE_TIMER[stage], stageStart, raw);
+    if (stage == STAGE_PDS) hashBytes(pdsHash, frame.data, frame.len);
+}
+
+// Las mismas etapas que MCU.ino, sin UDP, con todas las salidas y sin
+// RateControl: cada consumidor ve cada trama y la corrida es repetible
+static void processFrame(Frame& frame) {
+    frameStages.process(frame, STREAM_ALL);
+}
+
+static void outputFrame(Frame& frame) {
+    frameStages.output(frame, STREAM_ALL);
+}
+
+// Intensidad que sube y baja despacio, con destellos y algo de ruido
+static void synthesize(uint8_t* data, size_t len, uint8_t channels) {
+    uint32_t lcg = 12345;
+    for (size_t i = 0; i < len; ++i) {
+        const size_t t = i / channels;
+        const uint8_t c = i % channels;
+        lcg = lcg * 1664525u + 1013904223u;
+        double v = 128 + 90 * sin(2 * PI * t / (4096.0 + 512 * c));
+        if ((t / 1000) % 7 == 0 && t % 1000 < 40) v = 250;
+        v += (int)(lcg >> 29) - 4;
+        data[i] = v < 0 ? 0 : (v > 255 ? 255 : (uint8_t)v);
+    }
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "uso: %s [opciones] [captura.bin]\n"
+            "  captura.bin  volcado crudo de la SRAM (canales intercalados);\n"
+            "               sin archivo se usa una señal sintética\n"
+            "  -n N         tramas a procesar (%u)\n"
+            "  -f BYTES     bytes por trama (%zu)\n"
+            "  -c N         canales intercalados, 1..%u (%u)\n"
+            "  -m KIB       capacidad de la SRAM simulada (%zu)\n"
+            "  -k CODEC     0 crudo, 1 RLE, 2 delta+RLE, 3 delta+bits (%u)\n"
+            "  -o ARCHIVO   guardar resultados como referencia\n"
+            "  -b ARCHIVO   comparar con una referencia; falla si una etapa\n"
+            "               es más lenta que la tolerancia o cambia la salida\n"
+            "  -t PCT       tolerancia para -b (%.0f)\n",
+            argv0, sim.frames, sim.frameLen, FRAME_MAX_CHANNELS, sim.channels,
+            sim.sramBytes / 1024, sim.codec, sim.tolerance);
+}
+
+static bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (a[0] != '-') { sim.capture = a; continue; }
+        if (i + 1 >= argc || a[2] != '\0') return false;
+        const char* v = argv[++i];
+        switch (a[1]) {
+            case 'n': sim.frames = strtoul(v, nullptr, 0); break;
+            case 'f': sim.frameLen = strtoul(v, nullptr, 0); break;
+            case 'c': sim.channels = strtoul(v, nullptr, 0); break;
+            case 'm': sim.sramBytes = strtoul(v, nullptr, 0) * 1024; break;
+            case 'k': sim.codec = (FrameCodec)strtoul(v, nullptr, 0); break;
+            case 'o': sim.results = v; break;
+            case 'b': sim.baseline = v; break;
+            case 't': sim.tolerance = strtod(v, nullptr); break;
+            default: return false;
+        }
+    }
+    return sim.frames > 0 && sim.frameLen > 0 && sim.channels >= 1 &&
+           sim.channels <= FRAME_MAX_CHANNELS && sim.codec <= CODEC_DELTA_PACK;
+}
+
+static double nsPerFrame(const StageTimer& s) {
+    return s.frames ? (double)s.ns / s.frames : 0;
+}
+
+static void report(uint64_t wallNs) {
+    printf("\n%-18s %10s %12s %10s\n", "etapa", "tramas", "ns/trama", "MB/s");
+    for (const StageTimer& s : stages) {
+        const double mbps = s.ns ? s.bytes * 1e3 / s.ns : 0; // bytes/ns -> MB/s
+        printf("%*s%-*s %10llu %12.0f %10.1f\n", s.depth * 2, "", 18 - s.depth * 2, s.name,
+               (unsigned long long)s.frames, nsPerFrame(s), mbps);
+    }
+    const uint64_t frames = pipeline->outputStats().frames;
+    const double secs = wallNs / 1e9;
+    printf("\n%llu tramas en %.3f s: %.0f tramas/s, %.1f Mmuestras/s\n",
+           (unsigned long long)frames, secs, frames / secs,
+           stages[ST_ACQUIRE].bytes / secs / 1e6);
+    printf("bus SPI %llu bytes, UART %llu bytes, Net %u lotes, codec %u -> %u bytes\n",
+           (unsigned long long)sram.busBytes(), (unsigned long long)Serial.txBytes(),
+           net.batches(), compressor.rawBytes(), compressor.packedBytes());
+    printf("hash pds %016llx, uart %016llx\n",
+           (unsigned long long)pdsHash, (unsigned long long)Serial.txHash());
+}
+
+// Archivo de referencia, una línea por dato: "param|stage|hash nombre valor"
+static bool saveResults(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "param frames %u\nparam frameLen %zu\nparam channels %u\nparam codec %u\n",
+            sim.frames, sim.frameLen, sim.channels, sim.codec);
+    fprintf(f, "param capture %s\n", sim.capture ? sim.capture : "-");
+    for (const StageTimer& s : stages) fprintf(f, "stage %s %.1f\n", s.name, nsPerFrame(s));
+    fprintf(f, "hash pds %016llx\nhash uart %016llx\n",
+            (unsigned long long)pdsHash, (unsigned long long)Serial.txHash());
+    fclose(f);
+    return true;
+}
+
+static bool checkBaseline(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "no se puede leer %s\n", path);
+        return false;
+    }
+    char kind[16], name[32], value[256];
+    bool ok = true;
+    bool sameInput = true;
+    char current[32];
+    printf("\ncontra %s (tolerancia %.0f %%):\n", path, sim.tolerance);
+    while (fscanf(f, "%15s %31s %255s", kind, name, value) == 3) {
+        if (!strcmp(kind, "param")) {
+            if (!strcmp(name, "frames")) snprintf(current, sizeof(current), "%u", sim.frames);
+            else if (!strcmp(name, "frameLen")) snprintf(current, sizeof(current), "%zu", sim.frameLen);
+            else if (!strcmp(name, "channels")) snprintf(current, sizeof(current), "%u", sim.channels);
+            else if (!strcmp(name, "codec")) snprintf(current, sizeof(current), "%u", sim.codec);
+            else continue; // la ruta de la captura puede cambiar
+            if (strcmp(current, value)) {
+                printf("  %s distinto (%s, referencia %s): solo se comparan tiempos\n", name, current, value);
+                sameInput = false;
+            }
+        } else if (!strcmp(kind, "stage")) {
+            for (const StageTimer& s : stages) {
+                if (strcmp(s.name, name)) continue;
+                const double ref = strtod(value, nullptr);
+                const double now = nsPerFrame(s);
+                const double diff = ref > 0 ? (now - ref) * 100 / ref : 0;
+                // Las etapas de pocas decenas de ns son puro ruido del reloj
+                const bool slow = diff > sim.tolerance && now - ref > MIN_SLOWDOWN_NS;
+                printf("  %-18s %10.0f -> %10.0f ns/trama %+6.1f %%%s\n", s.name, ref, now, diff,
+                       slow ? "  MÁS LENTA" : "");
+                ok &= !slow;
+            }
+        } else if (!strcmp(kind, "hash") && sameInput) {
+            const uint64_t ref = strtoull(value, nullptr, 16);
+            const uint64_t now = !strcmp(name, "pds") ? pdsHash : Serial.txHash();
+            if (ref != now) {
+                printf("  salida de %s distinta de la referencia\n", name);
+                ok = false;
+            }
+        }
+    }
+    fclose(f);
+    printf("%s\n", ok ? "sin regresiones" : "REGRESIÓN");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+    Serial.echo(false); // los Serial.print() del firmware no ensucian el informe
+
+    // La SRAM simulada tiene que existir antes de que RamReader detecte la geometría
+    if (!sram.begin(sim.sramBytes, SRAM_CS)) return 1;
+    SramConfig cfg;
+    cfg.channels = sim.channels;
+    ram = new RamReader(SRAM_CS, cfg);
+    ram->begin();
+    if (!ram->isReady() || ram->size() != sram.size()) {
+        fprintf(stderr, "RamReader no detectó la SRAM simulada (%u de %zu bytes)\n",
+                ram->size(), sram.size());
+        return 1;
+    }
+
+    if (sim.capture) {
+        const size_t n = sram.load(sim.capture);
+        if (n == 0) {
+            fprintf(stderr, "no se puede leer %s\n", sim.capture);
+            return 1;
+        }
+        printf("captura %s: %zu bytes", sim.capture, n);
+        if (n == sram.size()) printf(" (recortada a la SRAM)");
+        printf("\n");
+    } else {
+        uint8_t* data = (uint8_t*)malloc(sram.size());
+        if (!data) return 1;
+        synthesize(data, sram.size(), sim.channels);
+        sram.fill(data, sram.size());
+        free(data);
+        printf("señal sintética\n");
+    }
+    printf("SRAM %zu bytes, %u tramas de %zu bytes, %u canal(es), codec %u\n",
+           sram.size(), sim.frames, sim.frameLen, sim.channels, sim.codec);
+
+    // Mismos parámetros que setup(); -f cambia el tamaño de trama
+    PdsConfig filters;
+    filters.avgLog2 = 2;
+    filters.iirAlpha = Q15(0.25f);
+    pds.begin(filters);
+    pyramid.begin();
+    display.begin(16, sim.channels);
+    if (!pool.begin(8, sim.frameLen)) return 1;
+    compressor.setCodec(sim.codec);
+    compressor.begin(pool.frameBytes());
+    const size_t specBytes = spectrum.bins() * sizeof(uint16_t);
+    uartComm.begin(pool.frameBytes() > specBytes ? pool.frameBytes() : specBytes);
+    uartComm.setCodec(CODEC_DELTA_RLE);
+    net.begin(); // sin SSID: arma los lotes sin clientes
+
+    source = new SramSource(*ram, FRAME_PLANAR);
+    pipeline = new Pipeline<SramSource>(*source, pool);
+    frameStages.setProbe(probeStage);
+    pipeline->onProcess(processFrame);
+    pipeline->onOutput(outputFrame);
+    if (!pipeline->begin(0, sim.frameLen)) return 1;
+
+    // Las etapas en serie, como poll() pero midiendo cada una
+    // (la adquisición suma también las vueltas sin trama: la captura sin
+    // DMA lee la SRAM dentro de pollFrame())
+    const size_t frameLen = sim.frameLen - sim.frameLen % sim.channels;
+    const uint64_t start = nowNs();
+    while (pipeline->outputStats().frames < sim.frames) {
+        const uint32_t acquired = pipeline->acquireStats().frames;
+        uint64_t t0 = nowNs();
+        pipeline->acquireStep();
+        stages[ST_ACQUIRE].ns += nowNs() - t0;
+        if (pipeline->acquireStats().frames != acquired) {
+            ++stages[ST_ACQUIRE].frames;
+            stages[ST_ACQUIRE].bytes += frameLen;
+        }
+
+        t0 = nowNs();
+        if (pipeline->processStep()) account(ST_PROCESS, t0);
+
+        t0 = nowNs();
+        if (pipeline->outputStep()) account(ST_OUTPUT, t0);
+    }
+    const uint64_t wall = nowNs() - start;
+    net.flush();
+
+    // Las etapas completas cuentan las mismas muestras que la adquisición
+    stages[ST_PROCESS].bytes = stages[ST_OUTPUT].bytes = stages[ST_ACQUIRE].bytes;
+    report(wall);
+
+    bool ok = true;
+    if (sim.results && !saveResults(sim.results)) {
+        fprintf(stderr, "no se puede escribir %s\n", sim.results);
+        ok = false;
+    }
+    if (sim.baseline) ok &= checkBaseline(sim.baseline);
+    return ok ? 0 : 1;
+}
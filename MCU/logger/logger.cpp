@@ -0,0 +1,178 @@
+#include "logger.h"
+#include "../uart_comm/uart_comm.h" // UartComm::crc16
+
+static inline void logPut16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static inline void logPut32(uint8_t* p, uint32_t v) { logPut16(p, v); logPut16(p + 2, v >> 16); }
+static inline void logPut64(uint8_t* p, uint64_t v) { logPut32(p, v); logPut32(p + 4, v >> 32); }
+
+Logger::Logger()
+    : _data(nullptr), _index(nullptr), _chunkBytes(0), _active(0), _nextIndex(0),
+      _chunks(0), _frames(0), _dropped(0) {
+    for (Chunk& c : _chunk) {
+        c.buf = nullptr;
+        c.used = 0;
+        c.frames = 0;
+        c.full.store(false, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Logger::nowUs() {
+#if defined(ARDUINO_ARCH_ESP32)
+    return esp_timer_get_time();
+#else
+    return micros();
+#endif
+}
+
+bool Logger::begin(Print& data, Print* index, size_t chunkBytes) {
+    if (_data) return false;
+    // Múltiplo de 512 (sector de SD) para que cada escritura quede alineada
+    chunkBytes &= ~(size_t)511;
+    if (chunkBytes < 1024) return false;
+
+    for (Chunk& c : _chunk) {
+#if defined(ARDUINO_ARCH_ESP32)
+        c.buf = (uint8_t*)heap_caps_malloc(chunkBytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#else
+        c.buf = (uint8_t*)malloc(chunkBytes);
+#endif
+        if (!c.buf) { end(); return false; }
+        c.used = 0;
+        c.frames = 0;
+        c.full.store(false, std::memory_order_relaxed);
+    }
+    _chunkBytes = chunkBytes;
+    _data = &data;
+    _index = index;
+    _active = 0;
+    _nextIndex = 0;
+
+    // Un sector entero, armado en el búfer del primer bloque (aún libre)
+    uint8_t* hdr = _chunk[0].buf;
+    memset(hdr, 0, FILE_HEADER);
+    memcpy(hdr, "LXLOG", 6);
+    logPut16(hdr + 6, VERSION);
+    logPut32(hdr + 8, _chunkBytes);
+    _data->write(hdr, FILE_HEADER);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // Prioridad baja en el núcleo 0: la adquisición (3) le gana siempre
+    xTaskCreatePinnedToCore(writerTask, "log", 4096, this, 1, &_writer, 0);
+#endif
+    return true;
+}
+
+void Logger::end() {
+    if (_data) {
+#if defined(ARDUINO_ARCH_ESP32)
+        // Espera a que la tarea vacíe lo pendiente antes de detenerla
+        while (_chunk[0].full.load(std::memory_order_acquire) ||
+               _chunk[1].full.load(std::memory_order_acquire)) {
+            vTaskDelay(1);
+        }
+        if (_writer) vTaskDelete(_writer);
+        _writer = nullptr;
+#endif
+        Chunk& c = _chunk[_active];
+        if (c.frames) {
+            sealChunk(c);
+            writeChunk(c);
+        }
+    }
+    for (Chunk& c : _chunk) {
+        free(c.buf);
+        c.buf = nullptr;
+        c.used = 0;
+        c.frames = 0;
+        c.full.store(false, std::memory_order_relaxed);
+    }
+    _data = nullptr;
+    _index = nullptr;
+}
+
+void Logger::openChunk(Chunk& c, const Frame& first) {
+    uint8_t* h = c.buf;
+    memset(h, 0, CHUNK_HEADER);
+    memcpy(h, "CHNK", 4);
+    logPut32(h + 4, _nextIndex++);
+    logPut32(h + 8, first.seq);
+    logPut64(h + 16, nowUs());
+    c.used = CHUNK_HEADER;
+    c.frames = 0;
+}
+
+void Logger::sealChunk(Chunk& c) {
+    uint8_t* h = c.buf;
+    logPut16(h + 12, c.frames);
+    logPut32(h + 24, c.used - CHUNK_HEADER);
+    logPut16(h + 28, UartComm::crc16(h + CHUNK_HEADER, c.used - CHUNK_HEADER));
+    memset(c.buf + c.used, 0, _chunkBytes - c.used);
+}
+
+void Logger::writeChunk(Chunk& c) {
+    // Un único write del bloque completo
+    _data->write(c.buf, _chunkBytes);
+#if defined(ARDUINO_ARCH_ESP32)
+    _data->flush();
+#endif
+    if (_index) {
+        uint8_t e[20] = {0};
+        memcpy(e, c.buf + 4, 8);       // índice, primera seq
+        memcpy(e + 8, c.buf + 16, 8);  // tiempo
+        memcpy(e + 16, c.buf + 12, 2); // tramas
+        _index->write(e, sizeof(e));
+    }
+    ++_chunks;
+    c.used = 0;
+    c.frames = 0;
+}
+
+bool Logger::push(const Frame& frame) {
+    if (!_data) return false;
+    const size_t need = RECORD_HEADER + frame.len;
+    if (CHUNK_HEADER + need > _chunkBytes) { ++_dropped; return false; }
+
+    Chunk* c = &_chunk[_active];
+    if (c->full.load(std::memory_order_acquire)) { ++_dropped; return false; }
+    if (c->frames && c->used + need > _chunkBytes) {
+        sealChunk(*c);
+#if defined(ARDUINO_ARCH_ESP32)
+        c->full.store(true, std::memory_order_release);
+        xTaskNotifyGive(_writer);
+#else
+        writeChunk(*c);
+#endif
+        _active ^= 1;
+        c = &_chunk[_active];
+        // El otro aún se está escribiendo
+        if (c->full.load(std::memory_order_acquire)) { ++_dropped; return false; }
+    }
+    if (c->frames == 0) openChunk(*c, frame);
+
+    uint8_t* r = c->buf + c->used;
+    logPut32(r, frame.seq);
+    logPut32(r + 4, frame.stamp);
+    logPut32(r + 8, frame.addr);
+    r[12] = frameFormat(frame);
+    r[13] = 0;
+    logPut16(r + 14, frame.len);
+    memcpy(r + RECORD_HEADER, frame.data, frame.len);
+    c->used += need;
+    ++c->frames;
+    ++_frames;
+    return true;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void Logger::writerTask(void* arg) {
+    Logger* self = static_cast<Logger*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        for (Chunk& c : self->_chunk) {
+            if (!c.full.load(std::memory_order_acquire)) continue;
+            self->writeChunk(c);
+            c.full.store(false, std::memory_order_release);
+        }
+    }
+}
+#endif
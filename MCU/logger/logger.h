@@ -0,0 +1,81 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "../frame_pool/frame_pool.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#endif
+
+// Registro de larga duración en un archivo de solo agregado (LittleFS o SD).
+//
+// Formato (LE). Cabecera de archivo de FILE_HEADER bytes (un sector):
+//   "LXLOG\0" (6) | versión (2) | bytes por bloque (4) | ceros
+// Luego bloques de tamaño fijo chunkBytes, así el bloque k está en
+// FILE_HEADER + k * chunkBytes (alineado a sector) y el host salta a
+// cualquier punto sin recorrer el archivo. Cada bloque:
+//   "CHNK" (4) | índice (4) | primera seq (4) | tramas (2) | 0 (2)
+//   | tiempo en us desde el arranque (8) | bytes de registros (4) | crc16 (2) | 0 (2)
+//   registros: seq (4) | stamp (4) | addr (4) | formato (1) | 0 (1) | len (2) | datos
+//   (formato = codec y canales, ver frameFormat())
+//   relleno con ceros hasta chunkBytes
+// El índice aparte (opcional) recibe 20 bytes por bloque:
+//   índice (4) | primera seq (4) | tiempo en us (8) | tramas (2) | 0 (2)
+//
+// push() copia la trama al bloque en armado, ya en el búfer apto para DMA;
+// al llenarse pasa a la tarea de escritura, que manda el bloque entero de
+// una vez. Con dos búferes, la escritura de uno no frena el armado del
+// otro; si la tarjeta se atrasa más de un bloque se descartan tramas.
+class Logger {
+public:
+    static constexpr size_t FILE_HEADER = 512;
+    static constexpr size_t CHUNK_HEADER = 32;
+    static constexpr size_t RECORD_HEADER = 16;
+
+    Logger();
+    bool begin(Print& data, Print* index = nullptr, size_t chunkBytes = 16384);
+    void end(); // escribe el bloque parcial y detiene la tarea
+
+    bool push(const Frame& frame);
+
+    uint32_t chunks() const { return _chunks; }   // bloques escritos
+    uint32_t frames() const { return _frames; }   // tramas registradas
+    uint32_t dropped() const { return _dropped; } // descartadas por atraso
+
+private:
+    static constexpr uint16_t VERSION = 2; // 1: cabecera de archivo de 32 bytes
+
+    struct Chunk {
+        uint8_t* buf;
+        size_t used;
+        uint16_t frames;
+        // Lista para la tarea de escritura: release al pasarla, acquire al
+        // tomarla, para que used/frames y el búfer lleguen completos
+        std::atomic<bool> full;
+    };
+
+    void openChunk(Chunk& c, const Frame& first);
+    void sealChunk(Chunk& c);
+    void writeChunk(Chunk& c);
+    static uint64_t nowUs();
+
+    Print* _data;
+    Print* _index;
+    size_t _chunkBytes;
+    Chunk _chunk[2];
+    uint8_t _active;
+    uint32_t _nextIndex;
+    uint32_t _chunks;
+    uint32_t _frames;
+    uint32_t _dropped;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static void writerTask(void* arg);
+    TaskHandle_t _writer = nullptr;
+#endif
+};
+
+#endif // LOGGER_H
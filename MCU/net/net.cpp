@@ -1,5 +1,406 @@
 #include "net.h"
 
-Net::Net() {}
+#if defined(ARDUINO_ARCH_ESP32)
+#include <mbedtls/sha1.h>
+#include <mbedtls/base64.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#endif
 
-void Net::begin() {}
+Net::Net(FramePool& pool)
+    : _pool(pool), _batchLen(0), _msg(nullptr), _msgCap(0), _batches(0), _skipped(0) {}
+
+void Net::begin(const NetConfig& cfg) {
+    _cfg = cfg;
+    if (_cfg.batchFrames == 0) _cfg.batchFrames = 1;
+    if (_cfg.batchFrames > MAX_BATCH) _cfg.batchFrames = MAX_BATCH;
+    // La cabecera admite cargas de hasta 16 bits de longitud
+    while (_cfg.batchFrames > 1 && 2 + (size_t)_cfg.batchFrames * (FRAME_HEADER + _pool.frameBytes()) > 0xFFFF) {
+        --_cfg.batchFrames;
+    }
+
+    // Un único búfer para el mensaje del lote, reservado al iniciar
+    _msgCap = WS_HEADER_MAX + 2 + (size_t)_cfg.batchFrames * (FRAME_HEADER + _pool.frameBytes());
+    if (!_msg) _msg = (uint8_t*)malloc(_msgCap);
+    if (!_reply) _reply = (uint8_t*)malloc(4 + REPLY_BYTES);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // Pendiente de envío por cliente: un lote y una respuesta a la vez
+    _txCap = _msgCap + 4 + REPLY_BYTES;
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        Client& c = _clients[i];
+        c.state = WS_FREE;
+        c.txLen = 0;
+        if (!c.tx) c.tx = (uint8_t*)malloc(_txCap);
+    }
+    _lastPollMs = 0;
+    if (!_cfg.ssid) return;
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false); // el ahorro de energía del módem mete latencia
+    WiFi.begin(_cfg.ssid, _cfg.password);
+    _server.begin(_cfg.port);
+    _server.setNoDelay(true);
+#endif
+}
+
+void Net::push(Frame& frame) {
+    if (!_msg) return;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (clients() == 0) return; // sin nadie mirando no se retiene nada
+#endif
+
+    _pool.retain(&frame);
+    _batch[_batchLen++] = &frame;
+    if (_batchLen >= _cfg.batchFrames) flush();
+}
+
+size_t Net::buildMessage() {
+    // La carga se escribe tras el hueco de cabecera máxima; la cabecera se
+    // pone después pegada a la carga para que el mensaje quede contiguo.
+    uint8_t* p = _msg + WS_HEADER_MAX;
+    *p++ = _batchLen & 0xFF;
+    *p++ = _batchLen >> 8;
+    for (uint8_t i = 0; i < _batchLen; ++i) {
+        const Frame* f = _batch[i];
+        memcpy(p, &f->seq, 4); // ESP32 es little-endian
+        p += 4;
+        *p++ = frameFormat(*f);
+        *p++ = f->len & 0xFF;
+        *p++ = f->len >> 8;
+        memcpy(p, f->data, f->len);
+        p += f->len;
+    }
+    return p - (_msg + WS_HEADER_MAX);
+}
+
+void Net::flush() {
+    if (_batchLen == 0) return;
+    TRACE_SCOPE(TRACE_NET, _batchLen);
+
+    const size_t payload = buildMessage();
+    for (uint8_t i = 0; i < _batchLen; ++i) _pool.release(_batch[i]);
+    _batchLen = 0;
+    ++_batches;
+
+    // Cabecera WebSocket (servidor -> cliente, sin máscara), mensaje binario
+    uint8_t hdr[WS_HEADER_MAX];
+    size_t h = 0;
+    hdr[h++] = 0x82;
+    if (payload < 126) {
+        hdr[h++] = payload;
+    } else {
+        hdr[h++] = 126;
+        hdr[h++] = payload >> 8;
+        hdr[h++] = payload & 0xFF;
+    }
+    uint8_t* msg = _msg + WS_HEADER_MAX - h;
+    memcpy(msg, hdr, h);
+    const size_t len = h + payload;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    const uint32_t now = millis();
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        Client& c = _clients[i];
+        if (c.state != WS_OPEN) continue;
+        // Con envíos pendientes el lote iría detrás de ellos: se salta
+        drain(c);
+        if (c.txLen) { ++_skipped; continue; }
+        refill(c, now);
+        if (c.tokens < len) { ++_skipped; continue; }
+        c.tokens -= len;
+        if (!queue(c, msg, len)) continue; // socket caído (cerrado)
+        if (c.txLen) {
+            // No entró entero en la ventana TCP: este cliente recibe menos lotes
+            ++_slowWrites;
+            c.rateBps = (c.rateBps / 2 < MIN_RATE_BPS) ? MIN_RATE_BPS : c.rateBps / 2;
+            if (c.tokens > c.rateBps) c.tokens = c.rateBps;
+        } else {
+            c.rateBps += (_cfg.clientRateBps - c.rateBps) / 16;
+        }
+    }
+#else
+    (void)msg;
+    (void)len;
+#endif
+}
+
+void Net::sendText(const char* text, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+    uint8_t hdr[4];
+    size_t h = 0;
+    hdr[h++] = 0x81; // FIN + texto
+    if (len < 126) {
+        hdr[h++] = len;
+    } else {
+        if (len > 0xFFFF) len = 0xFFFF;
+        hdr[h++] = 126;
+        hdr[h++] = len >> 8;
+        hdr[h++] = len & 0xFF;
+    }
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        Client& c = _clients[i];
+        if (c.state != WS_OPEN) continue;
+        if (c.txLen + h + len > _txCap) continue; // no cabe: este cliente no la ve
+        if (queue(c, hdr, h)) queue(c, (const uint8_t*)text, len);
+    }
+#else
+    (void)text;
+    (void)len;
+#endif
+}
+
+bool Net::canSendText(size_t len) const {
+#if defined(ARDUINO_ARCH_ESP32)
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        const Client& c = _clients[i];
+        if (c.state == WS_OPEN && c.txLen + 4 + len > _txCap) return false;
+    }
+#else
+    (void)len;
+#endif
+    return true;
+}
+
+uint8_t Net::clients() const {
+#if defined(ARDUINO_ARCH_ESP32)
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) n += (_clients[i].state == WS_OPEN);
+    return n;
+#else
+    return 0;
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+void Net::poll() {
+    if (!_cfg.ssid) return;
+    // Se llama desde la salida en cada trama: basta con mirar cada 10 ms
+    const uint32_t now = millis();
+    if (now - _lastPollMs < 10) return;
+    _lastPollMs = now;
+
+    accept();
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        Client& c = _clients[i];
+        if (c.state == WS_FREE) continue;
+        drain(c);
+        if (c.state != WS_FREE) serviceClient(c);
+    }
+}
+
+void Net::accept() {
+    WiFiClient incoming = _server.accept();
+    if (!incoming) return;
+
+    for (uint8_t i = 0; i < MAX_CLIENTS; ++i) {
+        Client& c = _clients[i];
+        if (c.state != WS_FREE || !c.tx) continue;
+        c.sock = incoming;
+        c.sock.setNoDelay(true);
+        c.state = WS_HANDSHAKE;
+        c.rxLen = 0;
+        c.txLen = 0;
+        c.tokens = _cfg.clientRateBps;
+        c.rateBps = _cfg.clientRateBps;
+        c.refillMs = millis();
+        return;
+    }
+    incoming.stop(); // sin sitio
+}
+
+void Net::serviceClient(Client& c) {
+    if (!c.sock.connected()) { closeClient(c); return; }
+
+    int avail = c.sock.available();
+    if (avail > 0) {
+        size_t room = RX_BYTES - c.rxLen;
+        if ((size_t)avail > room) avail = room;
+        c.rxLen += c.sock.read(c.rx + c.rxLen, avail);
+    }
+
+    if (c.state == WS_HANDSHAKE) {
+        if (!handshake(c) && c.rxLen == RX_BYTES) closeClient(c); // petición demasiado larga
+        return;
+    }
+    parseMessages(c);
+}
+
+static const char* findHeader(const char* req, const char* name) {
+    // Busca "\r\nNombre:" sin distinguir mayúsculas; devuelve el valor
+    const size_t n = strlen(name);
+    for (const char* p = strstr(req, "\r\n"); p; p = strstr(p + 2, "\r\n")) {
+        const char* line = p + 2;
+        size_t i = 0;
+        while (i < n && line[i] && tolower(line[i]) == tolower(name[i])) ++i;
+        if (i == n && line[n] == ':') {
+            line += n + 1;
+            while (*line == ' ') ++line;
+            return line;
+        }
+    }
+    return nullptr;
+}
+
+bool Net::handshake(Client& c) {
+    if (c.rxLen < 4) return false;
+    c.rx[c.rxLen] = 0; // rx tiene un byte más que RX_BYTES
+    char* req = (char*)c.rx;
+    char* end = strstr(req, "\r\n\r\n");
+    if (!end) return false;
+
+    const char* key = findHeader(req, "Sec-WebSocket-Key");
+    if (!key) { closeClient(c); return true; }
+    size_t keyLen = strcspn(key, "\r\n");
+    if (keyLen > 32) { closeClient(c); return true; }
+
+    // Accept = base64(sha1(clave + GUID))
+    static const char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    char concat[32 + sizeof(GUID)];
+    memcpy(concat, key, keyLen);
+    memcpy(concat + keyLen, GUID, sizeof(GUID) - 1);
+    uint8_t sha[20];
+    mbedtls_sha1((const uint8_t*)concat, keyLen + sizeof(GUID) - 1, sha);
+    uint8_t accept[32];
+    size_t acceptLen = 0;
+    mbedtls_base64_encode(accept, sizeof(accept), &acceptLen, sha, sizeof(sha));
+
+    char resp[HANDSHAKE_BYTES];
+    const int n = snprintf(resp, sizeof(resp),
+                           "HTTP/1.1 101 Switching Protocols\r\n"
+                           "Upgrade: websocket\r\n"
+                           "Connection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: %.*s\r\n\r\n",
+                           (int)acceptLen, (const char*)accept);
+    if (n <= 0 || (size_t)n >= sizeof(resp) || !queue(c, (const uint8_t*)resp, n)) {
+        closeClient(c);
+        return true;
+    }
+
+    // Lo que llegó detrás de la petición ya es del protocolo WebSocket
+    const size_t used = (end + 4) - req;
+    memmove(c.rx, c.rx + used, c.rxLen - used);
+    c.rxLen -= used;
+    c.state = WS_OPEN;
+    return true;
+}
+
+void Net::parseMessages(Client& c) {
+    // Mensajes cliente -> servidor: siempre con máscara; solo se esperan
+    // mensajes cortos (control), así que no se admite longitud de 64 bits.
+    while (c.rxLen >= 2) {
+        const uint8_t opcode = c.rx[0] & 0x0F;
+        size_t len = c.rx[1] & 0x7F;
+        size_t h = 2;
+        if (len == 126) {
+            if (c.rxLen < 4) return;
+            len = ((size_t)c.rx[2] << 8) | c.rx[3];
+            h = 4;
+        } else if (len == 127) {
+            closeClient(c);
+            return;
+        }
+        if (!(c.rx[1] & 0x80) || h + 4 + len > RX_BYTES) { closeClient(c); return; }
+        if (c.rxLen < h + 4 + len) return; // incompleto
+
+        const uint8_t* mask = c.rx + h;
+        uint8_t* data = c.rx + h + 4;
+        for (size_t i = 0; i < len; ++i) data[i] ^= mask[i & 3];
+
+        switch (opcode) {
+            case 0x8: // close
+                sendControl(c, 0x8, data, len > 2 ? 2 : len);
+                closeClient(c);
+                return;
+            case 0x9: // ping
+                sendControl(c, 0xA, data, len);
+                break;
+            case 0x2: // binario: consulta o comando
+                if (_onMessage && _reply) {
+                    const size_t n = _onMessage(data, len, _reply + 4, REPLY_BYTES);
+                    if (n) sendReply(c, n);
+                }
+                break;
+            default:
+                break;
+        }
+
+        const size_t used = h + 4 + len;
+        memmove(c.rx, c.rx + used, c.rxLen - used);
+        c.rxLen -= used;
+    }
+}
+
+void Net::sendReply(Client& c, size_t len) {
+    // La respuesta ya está en _reply + 4; la cabecera va pegada delante
+    uint8_t* p = _reply + 4;
+    if (len < 126) {
+        *--p = len;
+    } else {
+        *--p = len & 0xFF;
+        *--p = len >> 8;
+        *--p = 126;
+    }
+    *--p = 0x82;
+    const size_t total = (_reply + 4 + len) - p;
+    if (!queue(c, p, total)) closeClient(c);
+}
+
+void Net::sendControl(Client& c, uint8_t opcode, const uint8_t* data, size_t len) {
+    if (len > 125) len = 125;
+    uint8_t msg[2 + 125] = {(uint8_t)(0x80 | opcode), (uint8_t)len};
+    if (len) memcpy(msg + 2, data, len);
+    if (!queue(c, msg, 2 + len)) closeClient(c);
+}
+
+void Net::closeClient(Client& c) {
+    c.sock.stop();
+    c.state = WS_FREE;
+    c.rxLen = 0;
+    c.txLen = 0;
+}
+
+bool Net::queue(Client& c, const uint8_t* data, size_t len) {
+    if (c.txLen + len > _txCap) return false;
+    if (c.txLen == 0) {
+        // Sin pendientes va directo al socket; lo que no entre se guarda
+        const int n = sendNow(c, data, len);
+        if (n < 0) { closeClient(c); return false; }
+        data += n;
+        len -= n;
+    }
+    memcpy(c.tx + c.txLen, data, len);
+    c.txLen += len;
+    return true;
+}
+
+void Net::drain(Client& c) {
+    if (c.txLen == 0) return;
+    const int n = sendNow(c, c.tx, c.txLen);
+    if (n < 0) { closeClient(c); return; }
+    memmove(c.tx, c.tx + n, c.txLen - n);
+    c.txLen -= n;
+}
+
+int Net::sendNow(Client& c, const uint8_t* data, size_t len) {
+    // MSG_DONTWAIT: el socket toma lo que quepa en su ventana y vuelve
+    const int n = lwip_send(c.sock.fd(), data, len, MSG_DONTWAIT);
+    if (n >= 0) return n;
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+}
+
+void Net::refill(Client& c, uint32_t now) {
+    const uint32_t elapsed = now - c.refillMs;
+    if (elapsed == 0) return;
+    c.refillMs = now;
+    uint64_t tokens = c.tokens + (uint64_t)c.rateBps * elapsed / 1000;
+    // Ráfaga máxima de un segundo
+    c.tokens = tokens > c.rateBps ? c.rateBps : (uint32_t)tokens;
+}
+
+#else
+
+void Net::poll() {}
+
+#endif
@@ -1,10 +1,114 @@
 #ifndef NET_H
 #define NET_H
 
+#include <Arduino.h>
+#include "../trace/trace.h"
+#include "../frame_pool/frame_pool.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+
+// Mensaje binario de un cliente. Puede escribir una respuesta en reply
+// (hasta cap bytes) y devolver su largo; 0 = sin respuesta.
+typedef size_t (*NetMessageHook)(const uint8_t* data, size_t len, uint8_t* reply, size_t cap);
+
+struct NetConfig {
+    const char* ssid = nullptr;     // sin SSID no se levanta Wi-Fi
+    const char* password = nullptr;
+    uint16_t port = 81;             // ws://<ip>:81/
+    uint8_t  batchFrames = 4;       // tramas por mensaje WebSocket
+    uint32_t clientRateBps = 250000; // tope por cliente (bytes/s)
+};
+
+// Servidor WebSocket de la gráfica en vivo.
+// push() retiene la trama del pool (sin copiarla) hasta completar un lote;
+// el lote se arma una sola vez en un mensaje binario y se envía el mismo
+// búfer a todos los clientes. Mensaje (LE):
+//   cantidad (2) | por trama: seq (4) | formato (1) | len (2) | carga
+// La carga va con el FrameCodec que traiga la trama (ver Compressor); el
+// formato lleva además canales y orden (frameFormat()) para superponerlos.
+// Cada cliente tiene un cubo de tokens: si no le alcanza, se salta el lote
+// para él sin frenar a los demás. Nunca se bloquea esperando al socket: lo
+// que no entra en la ventana TCP queda pendiente y, mientras quede, ese
+// cliente se salta los lotes. La tasa del cubo se adapta al enlace: un
+// envío que no entró entero la reduce a la mitad, y cada envío completo la
+// acerca de nuevo a clientRateBps.
 class Net {
 public:
-    Net();
-    void begin();
+    Net(FramePool& pool);
+    void begin(const NetConfig& cfg = NetConfig());
+    void poll();               // conexiones nuevas, handshake y mensajes entrantes
+    void push(Frame& frame);   // desde la etapa de salida del pipeline
+    void flush();              // envía el lote aunque no esté completo
+    // Mensaje de texto a todos los clientes, fuera del tope (diagnóstico)
+    void sendText(const char* text, size_t len);
+    bool canSendText(size_t len) const; // todos los clientes tienen sitio
+    void onMessage(NetMessageHook hook) { _onMessage = hook; }
+
+    uint8_t clients() const;
+    uint32_t batches() const { return _batches; }
+    uint32_t skipped() const { return _skipped; } // lotes saltados (tope del cliente o envío pendiente)
+    uint32_t slowWrites() const { return _slowWrites; } // envíos que no entraron enteros
+
+private:
+    static constexpr uint8_t MAX_CLIENTS = 4;
+    static constexpr uint8_t MAX_BATCH = 16;
+    static constexpr size_t RX_BYTES = 512; // petición HTTP o mensaje de control
+    static constexpr size_t WS_HEADER_MAX = 10;
+    static constexpr size_t FRAME_HEADER = 7; // seq + formato + len
+    static constexpr size_t REPLY_BYTES = 1024;
+    static constexpr size_t HANDSHAKE_BYTES = 160; // respuesta 101 completa
+    static constexpr uint32_t MIN_RATE_BPS = 8000;
+
+    size_t buildMessage();
+
+    FramePool& _pool;
+    NetConfig _cfg;
+    Frame* _batch[MAX_BATCH];
+    uint8_t _batchLen;
+    uint8_t* _msg;      // cabecera WebSocket + lote
+    size_t _msgCap;
+    uint32_t _batches;
+    uint32_t _skipped;
+    uint32_t _slowWrites = 0;
+    NetMessageHook _onMessage = nullptr;
+    uint8_t* _reply = nullptr; // cabecera WebSocket + respuesta al cliente
+
+#if defined(ARDUINO_ARCH_ESP32)
+    enum ClientState : uint8_t { WS_FREE, WS_HANDSHAKE, WS_OPEN };
+    struct Client {
+        WiFiClient sock;
+        ClientState state;
+        uint8_t rx[RX_BYTES + 1]; // + NUL para leer la petición HTTP como texto
+        size_t rxLen;
+        uint8_t* tx = nullptr; // lo que el socket no aceptó todavía (_txCap)
+        size_t txLen;
+        uint32_t tokens;     // bytes que puede recibir ahora
+        uint32_t rateBps;    // tasa adaptada al enlace (<= clientRateBps)
+        uint32_t refillMs;
+    };
+
+    void accept();
+    void serviceClient(Client& c);
+    bool handshake(Client& c);
+    void parseMessages(Client& c);
+    void sendControl(Client& c, uint8_t opcode, const uint8_t* data, size_t len);
+    void sendReply(Client& c, size_t len);
+    void closeClient(Client& c);
+    void refill(Client& c, uint32_t now);
+    // Escritura sin bloquear: lo que no entra en el socket queda en c.tx y
+    // sale en poll(). false = no cabía en c.tx (no se escribió nada) o el
+    // socket falló (cliente cerrado).
+    bool queue(Client& c, const uint8_t* data, size_t len);
+    void drain(Client& c);
+    int sendNow(Client& c, const uint8_t* data, size_t len);
+
+    WiFiServer _server;
+    Client _clients[MAX_CLIENTS];
+    size_t _txCap = 0;
+    uint32_t _lastPollMs;
+#endif
 };
 
 #endif // NET_H
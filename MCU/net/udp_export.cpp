@@ -0,0 +1,103 @@
+#include "udp_export.h"
+
+UdpExport::UdpExport()
+    : _ring(nullptr), _slotBytes(0), _seq(0), _sent(0), _resent(0), _missed(0) {
+#if defined(ARDUINO_ARCH_ESP32)
+    _listening = false;
+#endif
+}
+
+bool UdpExport::begin(size_t frameBytes, const UdpExportConfig& cfg) {
+    if (_ring || frameBytes == 0 || cfg.ringFrames == 0) return false;
+    _cfg = cfg;
+    _slotBytes = HEADER_BYTES + frameBytes;
+    _ring = (uint8_t*)malloc(_slotBytes * _cfg.ringFrames);
+    if (!_ring) return false;
+    // seq 0 no se usa: un slot vacío nunca coincide con lo pedido
+    memset(_ring, 0, _slotBytes * _cfg.ringFrames);
+    _seq = 1;
+    return true;
+}
+
+void UdpExport::end() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_listening) _udp.stop();
+    _listening = false;
+#endif
+    free(_ring);
+    _ring = nullptr;
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void UdpExport::send(const Frame& frame) {
+    if (!_ring || frame.len > _slotBytes - HEADER_BYTES) return;
+
+    // El paquete se arma directamente en su slot del anillo
+    const uint32_t seq = _seq++;
+    uint8_t* p = slot(seq);
+    p[0] = MAGIC0;
+    p[1] = MAGIC1;
+    p[2] = TYPE_DATA;
+    p[3] = frameFormat(frame); // SramSource ya separó los canales si es planar
+    put32(p + 4, seq);
+    put32(p + 8, frame.addr);
+    p[12] = frame.len & 0xFF;
+    p[13] = frame.len >> 8;
+    memcpy(p + HEADER_BYTES, frame.data, frame.len);
+
+    transmit(p, false);
+    ++_sent;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+void UdpExport::transmit(const uint8_t* packet, bool toRequester) {
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (!_listening) _listening = _udp.begin(_cfg.port);
+
+    const size_t len = HEADER_BYTES + (packet[12] | (packet[13] << 8));
+    const IPAddress group(_cfg.group[0], _cfg.group[1], _cfg.group[2], _cfg.group[3]);
+    if (toRequester) _udp.beginPacket(_udp.remoteIP(), _udp.remotePort());
+    else _udp.beginPacket(group, _cfg.port);
+    _udp.write(packet, len);
+    _udp.endPacket();
+}
+
+void UdpExport::poll() {
+    if (!_listening || !_ring) return;
+
+    int n;
+    while ((n = _udp.parsePacket()) > 0) {
+        uint8_t req[10];
+        if (n < (int)sizeof(req) || _udp.read(req, sizeof(req)) != sizeof(req)) continue;
+        if (req[0] != MAGIC0 || req[1] != MAGIC1 || req[2] != TYPE_NACK) continue;
+
+        const uint32_t first = get32(req + 4);
+        uint16_t count = req[8] | (req[9] << 8);
+        if (count > MAX_NACK) count = MAX_NACK;
+
+        for (uint16_t i = 0; i < count; ++i) {
+            const uint32_t seq = first + i;
+            const uint8_t* p = slot(seq);
+            // El slot puede tener ya una trama más nueva
+            if (get32(p + 4) != seq || p[2] != TYPE_DATA) { ++_missed; continue; }
+            transmit(p, true);
+            ++_resent;
+        }
+    }
+}
+
+#else
+
+// Sin Wi-Fi: el anillo se llena igual, así se puede medir el costo
+void UdpExport::transmit(const uint8_t*, bool) {}
+void UdpExport::poll() {}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef UDP_EXPORT_H
+#define UDP_EXPORT_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#endif
+
+struct UdpExportConfig {
+    uint8_t  group[4] = {239, 0, 76, 1}; // grupo multicast
+    uint16_t port = 5005;                // datos al grupo; NACK a este puerto del equipo
+    uint8_t  ringFrames = 64;            // tramas recientes guardadas para reenviar
+};
+
+// Exportación masiva por UDP multicast de los bloques crudos de la SRAM.
+// Sin TCP no hay bloqueo de cabeza de línea: si el Wi-Fi pierde paquetes el
+// host ve el hueco en seq y pide reenvío con un NACK; las últimas
+// ringFrames tramas se guardan (copiadas, porque Pds filtra en el sitio).
+//
+// Paquete de datos (LE): 'L' 'X' | tipo=1 | formato | seq (4) | addr (4) | len (2) | muestras
+// NACK del host:          'L' 'X' | tipo=2 | 0 | seq inicial (4) | cantidad (2)
+// formato es el de frameFormat() (canales - 1 en bits 4-6, planar en 7; el
+// codec siempre es crudo), el mismo que llevan UART, Net y Logger. Las
+// versiones anteriores mandaban 0 ahí, que se lee igual: 1 canal, crudo.
+class UdpExport {
+public:
+    UdpExport();
+    bool begin(size_t frameBytes, const UdpExportConfig& cfg = UdpExportConfig());
+    void end();
+
+    void send(const Frame& frame); // trama cruda, antes de Pds
+    void poll();                   // atiende los NACK pendientes
+
+    uint32_t sent() const { return _sent; }
+    uint32_t resent() const { return _resent; }
+    uint32_t missed() const { return _missed; } // pedidas que ya no estaban en el anillo
+
+private:
+    static constexpr uint8_t MAGIC0 = 'L';
+    static constexpr uint8_t MAGIC1 = 'X';
+    static constexpr uint8_t TYPE_DATA = 1;
+    static constexpr uint8_t TYPE_NACK = 2;
+    static constexpr size_t HEADER_BYTES = 14;
+    static constexpr uint16_t MAX_NACK = 32; // reenvíos por NACK
+
+    uint8_t* slot(uint32_t seq) { return _ring + (size_t)(seq % _cfg.ringFrames) * _slotBytes; }
+    void transmit(const uint8_t* packet, bool toRequester);
+
+    UdpExportConfig _cfg;
+    uint8_t* _ring;     // paquetes completos, listos para reenviar
+    size_t _slotBytes;
+    uint32_t _seq;
+    uint32_t _sent;
+    uint32_t _resent;
+    uint32_t _missed;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    WiFiUDP _udp;
+    bool _listening;
+#endif
+};
+
+#endif // UDP_EXPORT_H
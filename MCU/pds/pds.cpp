@@ -1,5 +1,123 @@
 #include "pds.h"
 
-Pds::Pds() {}
+Pds::Pds() { reset(); }
 
-void Pds::begin() {}
+void Pds::begin(const PdsConfig& cfg) {
+    configure(cfg);
+    reset();
+}
+
+void Pds::configure(const PdsConfig& cfg) {
+    const bool avgChanged = cfg.avgLog2 != _cfg.avgLog2;
+    _cfg = cfg;
+    if (_cfg.avgLog2 > AVG_MAX_LOG2) _cfg.avgLog2 = AVG_MAX_LOG2;
+    if (_cfg.decimation == 0) _cfg.decimation = 1;
+    if (_cfg.iirAlpha < 0) _cfg.iirAlpha = 0;
+    // El historial de la media solo vale para el mismo tamaño de ventana
+    if (avgChanged) {
+        for (State& st : _state) {
+            memset(st.hist, 0, sizeof(st.hist));
+            st.sum = 0;
+            st.histIdx = 0;
+        }
+    }
+}
+
+void Pds::reset() {
+    memset(_state, 0, sizeof(_state));
+}
+
+uint8_t Pds::fromQ15(int16_t value) {
+    // Redondeo al entero más cercano con saturación
+    int v = (((int)value + 128) >> 8) + 128;
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+inline int16_t Pds::step(State& st, int16_t x, bool& ready) {
+    // Media móvil de 2^k muestras: O(1) por muestra con la suma acumulada
+    if (_cfg.avgLog2) {
+        const uint8_t mask = (1 << _cfg.avgLog2) - 1;
+        st.sum += x - st.hist[st.histIdx];
+        st.hist[st.histIdx] = x;
+        st.histIdx = (st.histIdx + 1) & mask;
+        x = (int16_t)(st.sum >> _cfg.avgLog2);
+    }
+
+    // IIR de un polo: y += alfa * (x - y)
+    if (_cfg.iirAlpha) {
+        const int32_t target = (int32_t)x << 8;
+        st.iir += (int32_t)(((int64_t)(target - st.iir) * _cfg.iirAlpha) >> 15);
+        x = (int16_t)(st.iir >> 8);
+    }
+
+    // Decimación con promedio del bloque (filtro antialias de caja)
+    if (_cfg.decimation > 1) {
+        st.decAcc += x;
+        if (++st.decCount < _cfg.decimation) {
+            ready = false;
+            return 0;
+        }
+        x = (int16_t)(st.decAcc / _cfg.decimation);
+        st.decAcc = 0;
+        st.decCount = 0;
+    }
+
+    ready = true;
+    return x;
+}
+
+size_t Pds::process(const uint8_t* in, size_t len, int16_t* out, uint8_t channel) {
+    if (!in || !out || channel >= FRAME_MAX_CHANNELS) return 0;
+
+    State& st = _state[channel];
+    size_t n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        bool ready;
+        const int16_t y = step(st, toQ15(in[i]), ready);
+        if (ready) out[n++] = y;
+    }
+    return n;
+}
+
+size_t Pds::processPlane(State& st, const uint8_t* in, size_t len, uint8_t* out) {
+    // out <= in: cada salida cae en un índice <= al de su entrada
+    size_t n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        bool ready;
+        const int16_t y = step(st, toQ15(in[i]), ready);
+        if (ready) out[n++] = fromQ15(y);
+    }
+    return n;
+}
+
+size_t Pds::process(Frame& frame) {
+    TRACE_SCOPE(TRACE_PDS, frame.len);
+    const uint8_t channels = frame.channels > FRAME_MAX_CHANNELS ? FRAME_MAX_CHANNELS : frame.channels;
+
+    if (channels <= 1) {
+        frame.len = processPlane(_state[0], frame.data, frame.len, frame.data);
+        return frame.len;
+    }
+
+    size_t n = 0;
+    if (frame.layout == FRAME_PLANAR) {
+        // Todos los canales deciman con la misma fase: planos del mismo largo
+        const size_t per = frame.len / channels;
+        size_t outPer = 0;
+        for (uint8_t c = 0; c < channels; ++c) {
+            outPer = processPlane(_state[c], frame.data + c * per, per, frame.data + c * outPer);
+        }
+        n = outPer * channels;
+    } else {
+        // Intercalado: el estado rota con el canal de cada muestra
+        uint8_t c = 0;
+        for (size_t i = 0; i < frame.len; ++i) {
+            bool ready;
+            const int16_t y = step(_state[c], toQ15(frame.data[i]), ready);
+            if (ready) frame.data[n++] = fromQ15(y);
+            if (++c == channels) c = 0;
+        }
+    }
+    frame.len = n;
+    return n;
+}
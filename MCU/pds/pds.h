@@ -1,10 +1,67 @@
 #ifndef PDS_H
 #define PDS_H
 
+#include <Arduino.h>
+#include "../trace/trace.h"
+#include "../frame_pool/frame_pool.h"
+
+// Convierte una constante real en [-1, 1) a Q15
+constexpr int16_t Q15(float x) {
+    return (int16_t)(x >= 0.99997f ? 32767 : (x <= -1.0f ? -32768 : x * 32768.0f));
+}
+
+// Cadena de filtros: media móvil -> IIR paso bajo -> decimación
+struct PdsConfig {
+    uint8_t  avgLog2 = 0;     // ventana de la media móvil = 2^avgLog2 (0..6)
+    int16_t  iirAlpha = 0;    // coeficiente Q15 del IIR de un polo; 0 = sin IIR
+    uint8_t  decimation = 1;  // una salida por cada N muestras (promediadas)
+};
+
+// Procesamiento de señal sobre las muestras de 8 bits de la SRAM.
+// Trabaja en punto fijo Q15 (sin flotantes en el lazo por muestra) y el
+// estado de los filtros se conserva entre tramas, uno por canal.
 class Pds {
 public:
     Pds();
-    void begin();
+    void begin(const PdsConfig& cfg = PdsConfig());
+    void configure(const PdsConfig& cfg); // conserva el estado si se puede
+    void reset();
+    const PdsConfig& config() const { return _cfg; }
+
+    // Filtra len muestras del canal indicado; devuelve cuántas salidas Q15
+    // escribió en out (len / decimation, según la fase que arrastre la decimación).
+    size_t process(const uint8_t* in, size_t len, int16_t* out, uint8_t channel = 0);
+    // Igual, pero en la propia trama y de vuelta a 8 bits (frame.len se
+    // ajusta). En FRAME_PLANAR cada plano se filtra en un lazo sin paso y
+    // los planos decimados quedan contiguos.
+    size_t process(Frame& frame);
+
+    static int16_t toQ15(uint8_t sample) { return (int16_t)(((int)sample - 128) << 8); }
+    static uint8_t fromQ15(int16_t value);
+
+private:
+    static constexpr uint8_t AVG_MAX_LOG2 = 6;
+
+    // Estado de los filtros de un canal
+    struct State {
+        // Media móvil: historial circular y suma acumulada
+        int16_t hist[1 << AVG_MAX_LOG2];
+        int32_t sum;
+        uint8_t histIdx;
+
+        // IIR: estado en Q23 para no perder resolución con alfas pequeños
+        int32_t iir;
+
+        // Decimación: acumulador y fase
+        int32_t decAcc;
+        uint8_t decCount;
+    };
+
+    inline int16_t step(State& st, int16_t x, bool& ready);
+    size_t processPlane(State& st, const uint8_t* in, size_t len, uint8_t* out);
+
+    PdsConfig _cfg;
+    State _state[FRAME_MAX_CHANNELS];
 };
 
 #endif // PDS_H
@@ -0,0 +1,153 @@
+#include "pyramid.h"
+
+Pyramid::Pyramid()
+    : _cells(nullptr), _cellCount(0), _levels(0), _baseLog2(0), _total(0) {}
+
+bool Pyramid::begin(uint8_t levels, size_t cells, uint8_t baseLog2) {
+    if (_cells) return true;
+    if (levels == 0 || levels > MAX_LEVELS || cells == 0 || baseLog2 + levels > 31) return false;
+    _cells = (Summary*)malloc(sizeof(Summary) * levels * cells);
+    if (!_cells) return false;
+    _levels = levels;
+    _cellCount = cells;
+    _baseLog2 = baseLog2;
+    reset();
+    return true;
+}
+
+void Pyramid::end() {
+    free(_cells);
+    _cells = nullptr;
+    _levels = 0;
+}
+
+void Pyramid::reset() {
+    beginWrite();
+    _total = 0;
+    _acc = {255, 0, 0, 0};
+    for (uint8_t k = 0; k < MAX_LEVELS; ++k) _done[k] = 0;
+    endWrite();
+}
+
+void Pyramid::beginWrite() {
+    // Versión impar durante la escritura: los lectores reintentan
+    _version.store(_version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void Pyramid::endWrite() {
+    _version.store(_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint64_t Pyramid::total() const {
+    for (;;) {
+        const uint32_t v = _version.load(std::memory_order_acquire);
+        if (v & 1) continue;
+        const uint64_t total = _total;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_version.load(std::memory_order_relaxed) == v) return total;
+    }
+}
+
+Summary Pyramid::merge(Summary a, Summary b) {
+    Summary s;
+    s.min = a.min < b.min ? a.min : b.min;
+    s.max = a.max > b.max ? a.max : b.max;
+    s.mean = (a.mean + b.mean + 1) >> 1; // las dos celdas tienen igual cantidad
+    return s;
+}
+
+void Pyramid::emit(uint8_t level, Summary s) {
+    // Sube mientras el nivel complete pares
+    while (level < _levels) {
+        const uint64_t idx = _done[level]++;
+        _cells[level * _cellCount + idx % _cellCount] = s;
+        if ((idx & 1) == 0) {
+            _pending[level] = s;
+            return;
+        }
+        s = merge(_pending[level], s);
+        ++level;
+    }
+}
+
+void Pyramid::push(const uint8_t* samples, size_t len) {
+    if (!_cells) return;
+    beginWrite();
+    const uint32_t span = 1u << _baseLog2;
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t v = samples[i];
+        if (v < _acc.min) _acc.min = v;
+        if (v > _acc.max) _acc.max = v;
+        _acc.sum += v;
+        if (++_acc.count == span) {
+            emit(0, {_acc.min, _acc.max, (uint8_t)((_acc.sum + span / 2) >> _baseLog2)});
+            _acc = {255, 0, 0, 0};
+        }
+    }
+    _total += len;
+    endWrite();
+}
+
+bool Pyramid::cell(uint8_t level, uint64_t index, Summary& s) const {
+    const uint64_t done = _done[level];
+    if (index >= done || done - index > _cellCount) return false;
+    s = _cells[level * _cellCount + index % _cellCount];
+    return true;
+}
+
+size_t Pyramid::query(uint64_t first, uint64_t count, Summary* out, size_t pixels) const {
+    if (!_cells || !out || pixels == 0 || count == 0) return 0;
+    for (uint8_t t = 0; t < QUERY_TRIES; ++t) {
+        const uint32_t v = _version.load(std::memory_order_acquire);
+        if (v & 1) continue;
+        const size_t n = collect(first, count, out, pixels);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_version.load(std::memory_order_relaxed) == v) return n;
+    }
+    return 0;
+}
+
+size_t Pyramid::collect(uint64_t first, uint64_t count, Summary* out, size_t pixels) const {
+    // Una lectura pisada por push() puede ver contadores a medias; los
+    // recorridos quedan acotados por _cellCount y query() la descarta
+
+    // Nivel más fino con a lo sumo ~2 celdas por columna que aún guarde el
+    // principio del tramo
+    const uint64_t perPixel = (count + pixels - 1) / pixels;
+    uint8_t level = 0;
+    while (level + 1 < _levels && ((uint64_t)samplesPerCell(level) << 1) <= perPixel) ++level;
+    for (;; ++level) {
+        if (level >= _levels) return 0;
+        const uint64_t firstCell = first >> (_baseLog2 + level);
+        if (_done[level] <= firstCell + _cellCount) break;
+    }
+
+    // Solo se recorren celdas guardadas, aunque la columna abarque más
+    const uint8_t shift = _baseLog2 + level;
+    const uint64_t done = _done[level];
+    const uint64_t oldest = done > _cellCount ? done - _cellCount : 0;
+    for (size_t p = 0; p < pixels; ++p) {
+        const uint64_t a = first + count * p / pixels;
+        uint64_t b = first + count * (p + 1) / pixels;
+        if (b <= a) b = a + 1;
+
+        Summary acc = {255, 0, 0};
+        uint32_t meanSum = 0, n = 0;
+        uint64_t c0 = a >> shift;
+        uint64_t c1 = ((b - 1) >> shift) + 1;
+        if (c0 < oldest) c0 = oldest;
+        if (c1 > done) c1 = done;
+        for (uint64_t c = c0; c < c1; ++c) {
+            Summary s;
+            if (!cell(level, c, s)) continue;
+            if (s.min < acc.min) acc.min = s.min;
+            if (s.max > acc.max) acc.max = s.max;
+            meanSum += s.mean;
+            ++n;
+        }
+        acc.mean = n ? (meanSum + n / 2) / n : 0;
+        out[p] = acc;
+    }
+    return pixels;
+}
@@ -0,0 +1,71 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Resumen de un tramo de muestras
+struct Summary {
+    uint8_t min;
+    uint8_t max;
+    uint8_t mean;
+};
+
+// Pirámide de resúmenes min/max/media en niveles de potencia de 2.
+// El nivel k resume 2^(baseLog2 + k) muestras por celda y guarda las
+// últimas `cells` celdas en un anillo, así los niveles altos abarcan horas
+// con poca memoria. Se actualiza por trama: cada celda completa de un nivel
+// se combina con su vecina y sube al siguiente, O(1) amortizado por celda.
+// query() elige el nivel más fino que alcance y lee O(pixels) celdas.
+// Las muestras se numeran desde begin() (contador de 64 bits).
+// push() (etapa de proceso) y query()/total() (etapa de salida) corren en
+// tareas distintas: como en CommandChannel, un seqlock. query() reintenta
+// si un push() la pisó y devuelve 0 si no logra una lectura limpia.
+class Pyramid {
+public:
+    static constexpr uint8_t MAX_LEVELS = 20;
+
+    Pyramid();
+    bool begin(uint8_t levels = 16, size_t cells = 256, uint8_t baseLog2 = 4);
+    void end();
+    void reset();
+
+    void push(const uint8_t* samples, size_t len);
+
+    // Resume [first, first + count) en `pixels` columnas. Devuelve cuántas
+    // escribió (0 si el tramo ya salió de todos los niveles); las columnas
+    // sin datos quedan con min > max.
+    size_t query(uint64_t first, uint64_t count, Summary* out, size_t pixels) const;
+
+    uint64_t total() const; // muestras recibidas
+    uint8_t levels() const { return _levels; }
+    uint32_t samplesPerCell(uint8_t level) const { return 1u << (_baseLog2 + level); }
+
+private:
+    struct Acc {
+        uint8_t min, max;
+        uint32_t sum;
+        uint32_t count;
+    };
+
+    void emit(uint8_t level, Summary s);
+    static Summary merge(Summary a, Summary b);
+    bool cell(uint8_t level, uint64_t index, Summary& s) const;
+    size_t collect(uint64_t first, uint64_t count, Summary* out, size_t pixels) const;
+    void beginWrite();
+    void endWrite();
+
+    static constexpr uint8_t QUERY_TRIES = 8;
+
+    Summary* _cells;    // levels x cells
+    size_t _cellCount;
+    uint8_t _levels;
+    uint8_t _baseLog2;
+    uint64_t _total;
+    Acc _acc;                        // celda en curso del nivel 0
+    uint64_t _done[MAX_LEVELS];      // celdas completas por nivel
+    Summary _pending[MAX_LEVELS];    // celda par esperando a su vecina
+    std::atomic<uint32_t> _version{0}; // impar mientras push() escribe
+};
+
+#endif // PYRAMID_H
@@ -0,0 +1,220 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "pds.h"
+
+// Tablas del FFT generadas en compilación (quedan en flash)
+namespace fft_detail {
+
+constexpr double FFT_PI = 3.14159265358979323846; // PI ya es macro del núcleo Arduino
+
+constexpr double sine(double x) {
+    while (x > FFT_PI) x -= 2 * FFT_PI;
+    while (x < -FFT_PI) x += 2 * FFT_PI;
+    // Serie de Taylor; en [-pi, pi] el error con 14 términos es < 1e-12
+    double term = x, sum = x;
+    for (int i = 1; i < 14; ++i) {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr int16_t toQ15(double v) {
+    return v >= 32767.0 / 32768.0 ? 32767 : (v <= -1.0 ? -32768 : (int16_t)(v * 32768.0));
+}
+
+template <size_t N>
+struct Tables {
+    int16_t cos[N / 2]; // cos(2*pi*k/N)
+    int16_t sin[N / 2]; // sin(2*pi*k/N)
+    int16_t win[N];     // ventana de Hann
+    uint16_t rev[N / 2]; // permutación bit-reverse del FFT complejo de N/2
+
+    constexpr Tables() : cos(), sin(), win(), rev() {
+        size_t bits = 0;
+        while ((size_t(1) << bits) < N / 2) ++bits;
+        for (size_t k = 0; k < N / 2; ++k) {
+            cos[k] = toQ15(sine(2 * FFT_PI * k / N + FFT_PI / 2));
+            sin[k] = toQ15(sine(2 * FFT_PI * k / N));
+            size_t r = 0;
+            for (size_t b = 0; b < bits; ++b) r |= ((k >> b) & 1) << (bits - 1 - b);
+            rev[k] = r;
+        }
+        for (size_t n = 0; n < N; ++n) {
+            win[n] = toQ15(0.5 - 0.5 * sine(2 * FFT_PI * n / N + FFT_PI / 2));
+        }
+    }
+};
+
+} // namespace fft_detail
+
+// Espectro de magnitud de la intensidad (parpadeo de red, PWM de atenuación).
+// FFT real de N puntos en Q15 calculada como FFT compleja de N/2 con
+// separación final; radix-2 con escalado 1/2 por etapa (no desborda).
+// En modo solapado push() va acumulando muestras y calcula un espectro cada
+// `hop` muestras nuevas sobre las últimas N, con ventana de Hann.
+// El resultado se publica en triple búfer: otra tarea puede leerlo con
+// takeLatest() mientras se calcula el siguiente.
+template <size_t N>
+class Spectrum {
+    static_assert(N >= 16 && N <= 4096 && (N & (N - 1)) == 0, "N potencia de dos en [16, 4096]");
+
+public:
+    explicit Spectrum(size_t hop = N / 2) : _hop(hop ? (hop > N ? N : hop) : N / 2) { reset(); }
+
+    void reset() {
+        _pos = 0;
+        _fill = 0;
+        _since = 0;
+        _count = 0;
+    }
+
+    static constexpr size_t bins() { return N / 2; }
+    static float binHz(float sampleRate) { return sampleRate / N; }
+
+    // Devuelve true si con estas muestras salió al menos un espectro nuevo
+    bool push(const int16_t* samples, size_t len) {
+        bool fresh = false;
+        for (size_t i = 0; i < len; ++i) fresh |= pushSample(samples[i]);
+        return fresh;
+    }
+
+    // Con varias, solo el canal indicado
+    bool push(const Frame& frame, uint8_t channel = 0) {
+        const uint8_t* p = frameChannel(frame, channel);
+        const size_t stride = frameStride(frame);
+        const size_t n = frameSamples(frame);
+        bool fresh = false;
+        for (size_t i = 0; i < n; ++i) fresh |= pushSample(Pds::toQ15(p[i * stride]));
+        return fresh;
+    }
+
+    // Espectro de un bloque de N muestras ya alineado
+    void compute(const int16_t* block) {
+        for (size_t n = 0; n < N / 2; ++n) {
+            _zr[n] = mulQ15(block[2 * n], T.win[2 * n]);
+            _zi[n] = mulQ15(block[2 * n + 1], T.win[2 * n + 1]);
+        }
+        transform();
+    }
+
+    // Último espectro publicado (bins() magnitudes) o nullptr si no hay nuevo
+    const uint16_t* takeLatest() {
+        if (!(_middle.load(std::memory_order_acquire) & NEW_BIT)) return nullptr;
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return _mag[_front];
+    }
+
+    // Bin de mayor magnitud sin contar la continua
+    static size_t peakBin(const uint16_t* mag) {
+        size_t best = 1;
+        for (size_t k = 2; k < N / 2; ++k) if (mag[k] > mag[best]) best = k;
+        return best;
+    }
+
+    uint32_t count() const { return _count; }
+
+private:
+    static constexpr fft_detail::Tables<N> T{};
+    static constexpr size_t M = N / 2;
+    static constexpr uint8_t NEW_BIT = 0x80;
+    static constexpr uint8_t INDEX_MASK = 0x03;
+
+    static int16_t mulQ15(int32_t a, int32_t b) { return (int16_t)((a * b) >> 15); }
+
+    bool pushSample(int16_t x) {
+        _ring[_pos] = x;
+        _pos = (_pos + 1) & (N - 1);
+        if (_fill < N) ++_fill;
+        if (_fill < N || ++_since < _hop) return false;
+        _since = 0;
+
+        // Las N últimas muestras empiezan en _pos (la más antigua)
+        for (size_t n = 0; n < M; ++n) {
+            const size_t a = (_pos + 2 * n) & (N - 1);
+            const size_t b = (a + 1) & (N - 1);
+            _zr[n] = mulQ15(_ring[a], T.win[2 * n]);
+            _zi[n] = mulQ15(_ring[b], T.win[2 * n + 1]);
+        }
+        transform();
+        return true;
+    }
+
+    void transform() {
+        // Pares/impares como real/imaginario: z[n] = x[2n] + j x[2n+1]
+        for (size_t k = 0; k < M; ++k) {
+            const size_t r = T.rev[k];
+            if (r > k) {
+                int16_t t = _zr[k]; _zr[k] = _zr[r]; _zr[r] = t;
+                t = _zi[k]; _zi[k] = _zi[r]; _zi[r] = t;
+            }
+        }
+
+        // FFT compleja de M puntos; W_M^j = W_N^(2j)
+        for (size_t len = 2; len <= M; len <<= 1) {
+            const size_t half = len / 2;
+            const size_t tstep = N / len;
+            for (size_t i = 0; i < M; i += len) {
+                for (size_t j = 0; j < half; ++j) {
+                    const int32_t wr = T.cos[j * tstep];
+                    const int32_t wi = -T.sin[j * tstep];
+                    const size_t a = i + j, b = a + half;
+                    const int32_t tr = (_zr[b] * wr - _zi[b] * wi) >> 15;
+                    const int32_t ti = (_zr[b] * wi + _zi[b] * wr) >> 15;
+                    const int32_t ar = _zr[a], ai = _zi[a];
+                    _zr[a] = (int16_t)((ar + tr) >> 1);
+                    _zi[a] = (int16_t)((ai + ti) >> 1);
+                    _zr[b] = (int16_t)((ar - tr) >> 1);
+                    _zi[b] = (int16_t)((ai - ti) >> 1);
+                }
+            }
+        }
+
+        // Separación: X[k] = E[k] + W_N^k O[k]
+        //   E = (Z[k] + conj(Z[M-k])) / 2,  O = (Z[k] - conj(Z[M-k])) / 2j
+        uint16_t* mag = _mag[_back];
+        mag[0] = magnitude((int32_t)_zr[0] + _zi[0], 0);
+        for (size_t k = 1; k < M; ++k) {
+            const int32_t zr = _zr[k], zi = _zi[k];
+            const int32_t cr = _zr[M - k], ci = -_zi[M - k];
+            const int32_t er = (zr + cr) >> 1, ei = (zi + ci) >> 1;
+            const int32_t orr = (zi - ci) >> 1, oi = -(zr - cr) >> 1;
+            const int32_t c = T.cos[k], s = T.sin[k];
+            const int32_t xr = er + ((c * orr + s * oi) >> 15);
+            const int32_t xi = ei + ((c * oi - s * orr) >> 15);
+            mag[k] = magnitude(xr, xi);
+        }
+
+        ++_count;
+        _back = _middle.exchange(_back | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    static uint16_t magnitude(int32_t re, int32_t im) {
+        // |z| ~ max + 3/8 min (error < 7 %), sin raíz cuadrada
+        uint32_t a = re < 0 ? -re : re;
+        uint32_t b = im < 0 ? -im : im;
+        if (a < b) { uint32_t t = a; a = b; b = t; }
+        uint32_t m = a + ((3 * b) >> 3);
+        return (uint16_t)(m > 0xFFFF ? 0xFFFF : m);
+    }
+
+    size_t _hop;
+    int16_t _ring[N];
+    size_t _pos;
+    size_t _fill;
+    size_t _since;
+    uint32_t _count;
+
+    int16_t _zr[M];
+    int16_t _zi[M];
+
+    uint16_t _mag[3][M];
+    uint8_t _back = 0;
+    uint8_t _front = 1;
+    std::atomic<uint8_t> _middle{2};
+};
+
+#endif // SPECTRUM_H
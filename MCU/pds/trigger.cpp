@@ -0,0 +1,166 @@
+#include "trigger.h"
+
+Trigger::Trigger(RamReader& ram)
+    : _ram(ram), _length(0), _cursor(0), _armed(false), _hasPrev(false), _hasLast(false),
+      _lastAt(0), _hits(0), _busBytes(0),
+      _coveredBytes(0) {}
+
+void Trigger::begin(const TriggerConfig& cfg) {
+    configure(cfg);
+    _hits = 0;
+    _busBytes = 0;
+    _coveredBytes = 0;
+}
+
+void Trigger::configure(const TriggerConfig& cfg) {
+    _cfg = cfg;
+    if (_cfg.stride == 0) _cfg.stride = 1;
+    if (_cfg.stride > FINE_BYTES) _cfg.stride = FINE_BYTES;
+    if (_cfg.minWidth == 0) _cfg.minWidth = 1;
+
+    // Sin longitud, hasta el final de la SRAM (si se conoce su tamaño)
+    const uint32_t ramSize = _ram.size();
+    _length = _cfg.length;
+    if (_length == 0 && ramSize > _cfg.base) _length = ramSize - _cfg.base;
+    if (_length && _cfg.stride > _length) _cfg.stride = _length;
+    rearm();
+}
+
+void Trigger::rearm() {
+    _cursor = 0;
+    _armed = false;
+    _hasPrev = false;
+    _hasLast = false;
+}
+
+inline bool Trigger::step(uint8_t s) {
+    // Los flancos necesitan ver antes la señal del otro lado de la histéresis
+    const int level = _cfg.level;
+    switch (_cfg.mode) {
+        case TRIG_RISING:
+        case TRIG_PULSE:
+            if (s + _cfg.hysteresis <= level) _armed = true;
+            else if (_armed && s >= level) { _armed = false; return true; }
+            return false;
+        case TRIG_FALLING:
+            if (s >= level + _cfg.hysteresis) _armed = true;
+            else if (_armed && s <= level) { _armed = false; return true; }
+            return false;
+        case TRIG_ABOVE:
+            return s >= level;
+        case TRIG_BELOW:
+            return s <= level;
+        default:
+            return false;
+    }
+}
+
+size_t Trigger::readRegion(uint32_t offset, uint8_t* buf, size_t len) {
+    // La región es circular: si el tramo cruza el final, dos segmentos en
+    // la misma transacción
+    offset = wrap(offset);
+    const size_t first = (len < _length - offset) ? len : _length - offset;
+    RamSegment segs[2] = {
+        {_cfg.base + offset, buf, first},
+        {_cfg.base, buf + first, len - first},
+    };
+    const size_t n = _ram.readMany(segs, first < len ? 2 : 1);
+    _busBytes += n;
+    return n;
+}
+
+bool Trigger::refine(uint32_t from, uint32_t count, bool armed, uint32_t& k) {
+    // Repite el detector muestra a muestra desde el estado de la muestra
+    // gruesa anterior; k = muestras desde from
+    _armed = armed;
+    for (uint32_t done = 0; done < count;) {
+        const size_t n = (count - done) < FINE_BYTES ? count - done : FINE_BYTES;
+        if (readRegion(from + done, _fine, n) != n) return false;
+        for (size_t j = 0; j < n; ++j) {
+            if (step(_fine[j])) { k = done + j; return true; }
+        }
+        done += n;
+    }
+    return false;
+}
+
+bool Trigger::pulseWidth(uint32_t start, uint16_t& width) {
+    // Cuenta muestras sobre level hasta que baja o supera maxWidth
+    const uint32_t limit = (uint32_t)_cfg.maxWidth + 1;
+    uint32_t count = 0;
+    while (count < limit) {
+        const size_t want = limit - count;
+        const size_t n = want < FINE_BYTES ? want : FINE_BYTES;
+        if (readRegion(start + count, _fine, n) != n) return false;
+        for (size_t k = 0; k < n; ++k, ++count) {
+            if (_fine[k] < _cfg.level) {
+                width = count;
+                return count >= _cfg.minWidth;
+            }
+        }
+    }
+    return false;
+}
+
+bool Trigger::scan(TriggerHit& hit) {
+    if (_length == 0) return false;
+
+    const uint32_t stride = _cfg.stride;
+    for (size_t i = 0; i < SCAN_BATCH; ++i) {
+        _segs[i] = {regionAddr(_cursor + i * stride), &_coarse[i], 1};
+    }
+    // Con captura DMA en curso readMany() no lee nada
+    if (_ram.readMany(_segs, SCAN_BATCH) != SCAN_BATCH) return false;
+    _busBytes += SCAN_BATCH;
+
+    for (size_t i = 0; i < SCAN_BATCH; ++i) {
+        const bool armed = _armed;
+        if (!step(_coarse[i])) continue;
+
+        // Muestra exacta entre la gruesa anterior y esta. Para la primera
+        // del lote la anterior es la última del lote previo; tras un
+        // disparo o rearm() no hay anterior y se queda la gruesa.
+        int32_t rel = (int32_t)(i * stride);
+        if (i > 0 || _hasPrev) {
+            const int32_t lo = rel - (int32_t)stride + 1;
+            uint32_t k;
+            if (refine(fromCursor(lo), stride, armed, k)) rel = lo + (int32_t)k;
+        }
+        _armed = false;
+
+        // La región es circular: el mismo flanco vuelve en cada vuelta
+        const uint32_t at = fromCursor(rel);
+        if (_hasLast && at == _lastAt) continue;
+
+        hit.width = 0;
+        if (_cfg.mode == TRIG_PULSE && !pulseWidth(at, hit.width)) continue;
+
+        const uint32_t pre = _cfg.preSamples % _length;
+        hit.addr = regionAddr(at);
+        hit.start = regionAddr(at + _length - pre);
+        _lastAt = at;
+        _hasLast = true;
+
+        // Sigue después de la ventana, siempre hacia adelante
+        int32_t advance = rel + _cfg.postSamples;
+        if (advance < 1) advance = 1;
+        _coveredBytes += advance;
+        _cursor = wrap(_cursor + advance);
+        _hasPrev = false;
+        ++_hits;
+        return true;
+    }
+
+    _coveredBytes += SCAN_BATCH * stride;
+    _cursor = wrap(_cursor + SCAN_BATCH * stride);
+    _hasPrev = true;
+    return false;
+}
+
+size_t Trigger::readWindow(const TriggerHit& hit, uint8_t* buf, size_t cap) {
+    if (_length == 0 || !buf) return 0;
+    size_t len = windowLen();
+    if (len > cap) len = cap;
+    if (len > _length) len = _length;
+    return readRegion(hit.start - _cfg.base, buf, len);
+}
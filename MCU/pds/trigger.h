@@ -0,0 +1,90 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <Arduino.h>
+#include "../ram_reader/ram_reader.h"
+
+enum TriggerMode : uint8_t {
+    TRIG_RISING  = 0, // cruce hacia arriba de level
+    TRIG_FALLING = 1, // cruce hacia abajo de level
+    TRIG_ABOVE   = 2, // nivel: muestra >= level
+    TRIG_BELOW   = 3, // nivel: muestra <= level
+    TRIG_PULSE   = 4, // pulso sobre level de minWidth..maxWidth muestras
+};
+
+struct TriggerConfig {
+    TriggerMode mode = TRIG_RISING;
+    uint8_t  level = 128;
+    uint8_t  hysteresis = 4;    // el flanco se rearma al alejarse esto de level
+    uint16_t minWidth = 1;      // TRIG_PULSE, en muestras
+    uint16_t maxWidth = 256;
+    uint16_t stride = 16;       // paso del barrido grueso (<= pulso más corto)
+    uint16_t preSamples = 64;   // muestras antes del disparo en la ventana
+    uint16_t postSamples = 448; // muestras desde el disparo (incluido)
+    uint32_t base = 0;          // región barrida de la SRAM
+    uint32_t length = 0;        // 0 = hasta el final de la SRAM
+};
+
+struct TriggerHit {
+    uint32_t addr;  // muestra que disparó
+    uint32_t start; // inicio de la ventana (addr - preSamples, con vuelta)
+    uint16_t width; // ancho del pulso (solo TRIG_PULSE)
+};
+
+// Disparo por software sobre la SRAM, antes de leerla entera.
+// scan() lee una muestra de cada `stride` con RamReader::readMany(); solo
+// alrededor de un posible disparo lee el tramo fino para ubicar la muestra
+// exacta, y readWindow() trae la ventana pre/post. Con la señal en reposo
+// el bus transfiere una fracción de lo que costaría leer todo.
+// Un evento más corto que stride puede pasar entre dos muestras gruesas.
+class Trigger {
+public:
+    Trigger(RamReader& ram);
+    void begin(const TriggerConfig& cfg = TriggerConfig());
+    void configure(const TriggerConfig& cfg);
+    const TriggerConfig& config() const { return _cfg; }
+    void rearm(); // vuelve al inicio de la región
+
+    // Barre como mucho SCAN_BATCH muestras gruesas desde donde quedó (la
+    // región se recorre en círculo). true si disparó; el barrido sigue
+    // después de la ventana y el mismo disparo no se repite en la vuelta
+    // siguiente (hasta rearm()).
+    bool scan(TriggerHit& hit);
+    // Lee la ventana del disparo; devuelve los bytes leídos
+    size_t readWindow(const TriggerHit& hit, uint8_t* buf, size_t cap);
+    size_t windowLen() const { return (size_t)_cfg.preSamples + _cfg.postSamples; }
+
+    uint32_t hits() const { return _hits; }
+    uint32_t busBytes() const { return _busBytes; }         // leídos por el disparo
+    uint32_t coveredBytes() const { return _coveredBytes; } // SRAM recorrida
+
+private:
+    static constexpr size_t SCAN_BATCH = 64;  // muestras gruesas por readMany()
+    static constexpr size_t FINE_BYTES = 256; // tramo fino por lectura
+
+    inline bool step(uint8_t sample);
+    uint32_t wrap(uint32_t offset) const { return offset % _length; }
+    uint32_t regionAddr(uint32_t offset) const { return _cfg.base + wrap(offset); }
+    // Desplazamiento a rel muestras del cursor (rel >= -stride)
+    uint32_t fromCursor(int32_t rel) const { return wrap(_cursor + _length + (uint32_t)rel); }
+    size_t readRegion(uint32_t offset, uint8_t* buf, size_t len);
+    bool refine(uint32_t from, uint32_t count, bool armed, uint32_t& k);
+    bool pulseWidth(uint32_t start, uint16_t& width);
+
+    RamReader& _ram;
+    TriggerConfig _cfg;
+    uint32_t _length;  // tamaño efectivo de la región
+    uint32_t _cursor;  // desplazamiento de la próxima muestra gruesa
+    bool _armed;
+    bool _hasPrev;     // la muestra gruesa anterior al cursor es del barrido
+    bool _hasLast;
+    uint32_t _lastAt;  // último disparo: no se repite en la vuelta siguiente
+    RamSegment _segs[SCAN_BATCH];
+    uint8_t _coarse[SCAN_BATCH];
+    uint8_t _fine[FINE_BYTES];
+    uint32_t _hits;
+    uint32_t _busBytes;
+    uint32_t _coveredBytes;
+};
+
+#endif // TRIGGER_H
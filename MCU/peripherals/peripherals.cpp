@@ -1,5 +1,172 @@
 #include "peripherals.h"
 
-Peripherals::Peripherals() {}
+Peripherals::Peripherals()
+    : _gain(0), _running(false), _events(0), _last(0), _minDelta(UINT32_MAX),
+      _maxDelta(0), _sumDelta(0), _deltas(0), _skipDelta(false), _nominal(0), _suspended(false) {
+#if defined(ARDUINO_ARCH_ESP32)
+    _timer = nullptr;
+    _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+}
 
-void Peripherals::begin() {}
+bool Peripherals::begin(const PeripheralsConfig& cfg) {
+    if (_running) end();
+    _cfg = cfg;
+    if (_cfg.sampleRateHz == 0) _cfg.sampleRateHz = 1;
+    if (_cfg.samplesPerFrame == 0) _cfg.samplesPerFrame = 1;
+
+    if (_cfg.pinAdcEnable >= 0) pinMode(_cfg.pinAdcEnable, OUTPUT);
+    if (_cfg.pinGain0 >= 0) pinMode(_cfg.pinGain0, OUTPUT);
+    if (_cfg.pinGain1 >= 0) pinMode(_cfg.pinGain1, OUTPUT);
+    setGain(_gain);
+    enableAdc(false);
+
+    _events = 0;
+    resetJitter();
+    uint32_t frameHz = _cfg.sampleRateHz / _cfg.samplesPerFrame;
+    if (frameHz == 0) frameHz = 1;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    _nominal = getCpuFrequencyMhz() * 1'000'000u / frameHz;
+
+    // Onda cuadrada al 50 %: 1 bit de resolución llega a 40 MHz
+    if (_cfg.pinSampleClock >= 0) {
+        if (_cfg.clockInSleep) {
+            // RC_FAST encendido durante el sueño ligero para que el LEDC siga
+            if (!ledcSetClockSource(LEDC_USE_RC_FAST_CLK)) return false;
+            esp_sleep_pd_config(ESP_PD_DOMAIN_RC_FAST, ESP_PD_OPTION_ON);
+        }
+        if (!ledcAttach(_cfg.pinSampleClock, _cfg.sampleRateHz, 1)) return false;
+        ledcWrite(_cfg.pinSampleClock, 1);
+    }
+
+    if (_cfg.pinWriteDone >= 0) {
+        pinMode(_cfg.pinWriteDone, INPUT);
+        attachInterruptArg(digitalPinToInterrupt(_cfg.pinWriteDone), onEvent, this, RISING);
+    } else {
+        _timer = timerBegin(TIMER_HZ);
+        if (!_timer) return false;
+        timerAttachInterruptArg(_timer, onEvent, this);
+        timerAlarm(_timer, TIMER_HZ / frameHz, true, 0);
+    }
+#else
+    _nominal = 1'000'000u / frameHz; // micros() hace de contador
+#endif
+
+    _running = true;
+    enableAdc(true);
+    return true;
+}
+
+void Peripherals::end() {
+    if (!_running) return;
+    _suspended = false;
+    enableAdc(false);
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_timer) {
+        timerEnd(_timer);
+        _timer = nullptr;
+    }
+    if (_cfg.pinWriteDone >= 0) detachInterrupt(digitalPinToInterrupt(_cfg.pinWriteDone));
+    if (_cfg.pinSampleClock >= 0) ledcDetach(_cfg.pinSampleClock);
+#endif
+    _running = false;
+}
+
+void Peripherals::suspend() {
+    if (!_running || _suspended) return;
+    if (!_cfg.clockInSleep) enableAdc(false);
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_cfg.pinSampleClock >= 0 && !_cfg.clockInSleep) ledcWrite(_cfg.pinSampleClock, 0);
+    if (_timer) timerStop(_timer);
+    if (_cfg.pinWriteDone >= 0) detachInterrupt(digitalPinToInterrupt(_cfg.pinWriteDone));
+#endif
+    _suspended = true;
+}
+
+void Peripherals::resume() {
+    if (!_running || !_suspended) return;
+    _skipDelta = true;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_cfg.pinWriteDone >= 0) {
+        attachInterruptArg(digitalPinToInterrupt(_cfg.pinWriteDone), onEvent, this, RISING);
+    }
+    if (_timer) timerStart(_timer);
+    if (_cfg.pinSampleClock >= 0 && !_cfg.clockInSleep) ledcWrite(_cfg.pinSampleClock, 1);
+#endif
+    if (!_cfg.clockInSleep) enableAdc(true);
+    _suspended = false;
+}
+
+void Peripherals::enableAdc(bool on) {
+    if (_cfg.pinAdcEnable >= 0) digitalWrite(_cfg.pinAdcEnable, on ? HIGH : LOW);
+}
+
+void Peripherals::setGain(uint8_t gain) {
+    _gain = gain & 0x03;
+    if (_cfg.pinGain0 >= 0) digitalWrite(_cfg.pinGain0, (_gain & 1) ? HIGH : LOW);
+    if (_cfg.pinGain1 >= 0) digitalWrite(_cfg.pinGain1, (_gain & 2) ? HIGH : LOW);
+}
+
+void IRAM_ATTR Peripherals::onEvent(void* arg) {
+    Peripherals* self = static_cast<Peripherals*>(arg);
+    self->record(cycles());
+}
+
+void IRAM_ATTR Peripherals::record(uint32_t now) {
+    // Solo aritmética entera: corre en la ISR
+#if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL_ISR(&_mux);
+#endif
+    const uint32_t n = _events;
+    _stamps[n % STAMP_RING] = now;
+    if (_skipDelta) {
+        _skipDelta = false;
+    } else if (n > 0) {
+        const uint32_t delta = now - _last;
+        if (delta < _minDelta) _minDelta = delta;
+        if (delta > _maxDelta) _maxDelta = delta;
+        _sumDelta += delta;
+        ++_deltas;
+    }
+    _last = now;
+    _events = n + 1;
+#if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL_ISR(&_mux);
+#endif
+}
+
+uint32_t Peripherals::stamp(uint32_t n) const {
+    const uint32_t events = _events;
+    if (n >= events || events - n > STAMP_RING) return 0;
+    return _stamps[n % STAMP_RING];
+}
+
+JitterStats Peripherals::jitter() const {
+    JitterStats s;
+#if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL(&_mux);
+#endif
+    s.events = _events;
+    s.minCycles = _deltas ? _minDelta : 0;
+    s.maxCycles = _maxDelta;
+    s.meanCycles = _deltas ? (uint32_t)(_sumDelta / _deltas) : 0;
+#if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL(&_mux);
+#endif
+    s.nominalCycles = _nominal;
+    return s;
+}
+
+void Peripherals::resetJitter() {
+#if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL(&_mux);
+#endif
+    _minDelta = UINT32_MAX;
+    _maxDelta = 0;
+    _sumDelta = 0;
+    _deltas = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL(&_mux);
+#endif
+}
@@ -1,10 +1,104 @@
 #ifndef PERIPHERALS_H
 #define PERIPHERALS_H
 
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_cpu.h>
+#include <esp_sleep.h>
+#endif
+
+// Líneas de la placa de adquisición; -1 = no conectada
+struct PeripheralsConfig {
+    int8_t   pinSampleClock = -1; // reloj de muestreo hacia el ADC externo
+    int8_t   pinAdcEnable = -1;   // habilita fotodiodo + ADC (activo en alto)
+    int8_t   pinWriteDone = -1;   // la SRAM terminó de escribir un bloque (flanco de subida)
+    int8_t   pinGain0 = -1;       // selección de ganancia, 2 bits
+    int8_t   pinGain1 = -1;
+    uint32_t sampleRateHz = 100000;
+    uint16_t samplesPerFrame = 16; // muestras por bloque/trama
+    // Reloj del LEDC desde RC_FAST (~8 MHz, menos exacto que el APB): es el
+    // único que sigue en sueño ligero, así el ADC llena la SRAM dormido
+    bool     clockInSleep = false;
+};
+
+// Intervalos entre eventos de trama, en ciclos de CPU
+struct JitterStats {
+    uint32_t events;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t meanCycles;
+    uint32_t nominalCycles; // período esperado
+};
+
+// Reloj de muestreo y líneas de control de la adquisición.
+// El reloj lo genera el LEDC (hardware, sin jitter de software). Cada
+// bloque escrito se marca con el contador de ciclos desde una ISR: la de
+// fin de escritura de la SRAM si está conectada, si no la de un timer a la
+// tasa de tramas. La misma ISR acumula la dispersión de los intervalos.
+// Las tramas las marca su fuente con cycles() al terminar de llegar (en
+// SramSource, la ISR de fin del DMA de su slot).
+// El contador de ciclos es por núcleo: las marcas son del núcleo que
+// llamó a begin().
 class Peripherals {
 public:
+    static constexpr uint8_t STAMP_RING = 16; // marcas recientes guardadas
+
     Peripherals();
-    void begin();
+    bool begin(const PeripheralsConfig& cfg = PeripheralsConfig());
+    void end();
+    const PeripheralsConfig& config() const { return _cfg; }
+    // Entre ráfagas: suelta la interrupción de fin de escritura y el timer
+    // de tramas; con clockInSleep el reloj y el ADC siguen muestreando (la
+    // SRAM se llena y sube el pin de despertar), si no también se apagan.
+    // resume() repone lo detenido sin reconfigurar el LEDC ni el timer; el
+    // hueco no entra en el jitter.
+    void suspend();
+    void resume();
+
+    void enableAdc(bool on);
+    void setGain(uint8_t gain); // 0..3
+    uint8_t gain() const { return _gain; }
+
+    // Contador de ciclos de este núcleo
+    static inline uint32_t cycles() {
+#if defined(ARDUINO_ARCH_ESP32)
+        return esp_cpu_get_cycle_count();
+#else
+        return micros();
+#endif
+    }
+
+    uint32_t events() const { return _events; }
+    // Marca del evento n (0 = el primero tras begin); 0 si ya salió del anillo
+    uint32_t stamp(uint32_t n) const;
+    JitterStats jitter() const;
+    void resetJitter();
+
+private:
+    static void IRAM_ATTR onEvent(void* arg);
+    void IRAM_ATTR record(uint32_t now);
+
+    PeripheralsConfig _cfg;
+    uint8_t _gain;
+    bool _running;
+
+    volatile uint32_t _stamps[STAMP_RING];
+    volatile uint32_t _events;
+    volatile uint32_t _last;
+    volatile uint32_t _minDelta;
+    volatile uint32_t _maxDelta;
+    volatile uint64_t _sumDelta;
+    volatile uint32_t _deltas;
+    volatile bool _skipDelta; // tras resume(): el primer intervalo no cuenta
+    uint32_t _nominal;
+    bool _suspended;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr uint32_t TIMER_HZ = 10'000'000; // resolución del timer de tramas
+    hw_timer_t* _timer;
+    mutable portMUX_TYPE _mux;
+#endif
 };
 
 #endif // PERIPHERALS_H
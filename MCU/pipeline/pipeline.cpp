@@ -0,0 +1,83 @@
+#include "pipeline.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define PIPELINE_WAKE(task) do { if (task) xTaskNotifyGive(task); } while (0)
+#else
+#define PIPELINE_WAKE(task) do {} while (0)
+#endif
+
+void PipelineCore::startStages() {
+#if defined(ARDUINO_ARCH_ESP32)
+    xTaskCreatePinnedToCore(processTask, "proc", 4096, this, 2, &_procTask, 1);
+    xTaskCreatePinnedToCore(outputTask, "out", 4096, this, 1, &_outTask, 1);
+#endif
+}
+
+bool PipelineCore::pushHeld() {
+    if (!_acqHeld) return true;
+    if (!_acqToProc.push(_acqHeld)) { ++_acqStats.stalls; return false; }
+    _acqHeld = nullptr;
+    PIPELINE_WAKE(_procTask);
+    return true;
+}
+
+bool PipelineCore::emit(Frame* frame) {
+    ++_acqStats.frames;
+    if (!_acqToProc.push(frame)) {
+        _acqHeld = frame;
+        ++_acqStats.stalls;
+        return true;
+    }
+    PIPELINE_WAKE(_procTask);
+    return true;
+}
+
+bool PipelineCore::processStep() {
+    if (!_procHeld) {
+        if (!_acqToProc.pop(_procHeld)) return false;
+        _procDone = false;
+        PIPELINE_WAKE(_acqTask); // sitio para una trama retenida
+    }
+
+    if (!_procDone) {
+        if (_process) _process(*_procHeld);
+        _procDone = true;
+        ++_procStats.frames;
+    }
+
+    if (!_procToOut.push(_procHeld)) { ++_procStats.stalls; return false; }
+    _procHeld = nullptr;
+    PIPELINE_WAKE(_outTask);
+    return true;
+}
+
+bool PipelineCore::outputStep() {
+    Frame* frame = nullptr;
+    if (!_procToOut.pop(frame)) {
+        if (_outputIdle) _outputIdle();
+        return false;
+    }
+
+    if (_output) _output(*frame);
+    ++_outStats.frames;
+
+    _pool.release(frame);
+    PIPELINE_WAKE(_acqTask); // la fuente pudo quedarse sin trama libre
+    return true;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void PipelineCore::processTask(void* arg) {
+    PipelineCore* self = static_cast<PipelineCore*>(arg);
+    for (;;) {
+        if (!self->processStep()) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+    }
+}
+
+void PipelineCore::outputTask(void* arg) {
+    PipelineCore* self = static_cast<PipelineCore*>(arg);
+    for (;;) {
+        if (!self->outputStep()) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+    }
+}
+#endif
@@ -0,0 +1,155 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include "spsc_queue.h"
+#include "../frame_pool/frame_pool.h"
+
+// Función de etapa: recibe la trama y puede modificarla en su sitio
+typedef void (*FrameHook)(Frame& frame);
+// Antes de pedir cada trama a la fuente, en la tarea de adquisición (p. ej.
+// para aplicar ajustes nuevos); false = no adquirir por ahora
+typedef bool (*AcquireHook)();
+// Etapa de salida sin tramas pendientes (en ESP32, al menos cada 10 ms)
+typedef void (*IdleHook)();
+
+struct StageStats {
+    uint32_t frames; // tramas que pasaron por la etapa
+    uint32_t stalls; // veces que la etapa esperó por la siguiente (contrapresión)
+};
+
+// Etapas de procesamiento y salida, comunes a cualquier fuente.
+class PipelineCore {
+public:
+    void onProcess(FrameHook hook) { _process = hook; }
+    void onOutput(FrameHook hook) { _output = hook; }
+    void onAcquire(AcquireHook hook) { _acquire = hook; }
+    void onOutputIdle(IdleHook hook) { _outputIdle = hook; }
+
+    // Un paso de cada etapa; devuelven true si movieron una trama
+    bool processStep();
+    bool outputStep();
+
+    const StageStats& acquireStats() const { return _acqStats; }
+    const StageStats& processStats() const { return _procStats; }
+    const StageStats& outputStats() const { return _outStats; }
+    // Tramas procesadas que esperan a la etapa de salida
+    size_t outputDepth() const { return _procToOut.size(); }
+
+protected:
+    static constexpr size_t STAGE_DEPTH = 4; // tramas en espera por etapa
+
+    PipelineCore(FramePool& pool) : _pool(pool) {}
+    void startStages(); // tareas de procesamiento y salida
+    bool pushHeld();    // reintenta la trama retenida; false si sigue llena
+    bool emit(Frame* frame);
+
+    FramePool& _pool;
+    FrameHook _process = nullptr;
+    FrameHook _output = nullptr;
+    AcquireHook _acquire = nullptr;
+    IdleHook _outputIdle = nullptr;
+
+    SpscQueue<Frame*, STAGE_DEPTH> _acqToProc;  // adquisición -> procesamiento
+    SpscQueue<Frame*, STAGE_DEPTH> _procToOut;  // procesamiento -> salida
+
+    // Trama retenida por cada etapa mientras la siguiente está llena
+    Frame* _acqHeld = nullptr;
+    Frame* _procHeld = nullptr;
+    bool _procDone = false;
+
+    StageStats _acqStats = {0, 0};
+    StageStats _procStats = {0, 0};
+    StageStats _outStats = {0, 0};
+
+#if defined(ARDUINO_ARCH_ESP32)
+    static void processTask(void* arg);
+    static void outputTask(void* arg);
+    TaskHandle_t _acqTask = nullptr;
+    TaskHandle_t _procTask = nullptr;
+    TaskHandle_t _outTask = nullptr;
+#endif
+};
+
+// Pipeline adquisición -> procesamiento -> salida, especializado en
+// compilación para la fuente de tramas (sin llamadas virtuales).
+// En ESP32 la adquisición corre en el núcleo 0 y las otras dos etapas en el
+// núcleo 1, unidas por colas SPSC; la salida devuelve las tramas al pool.
+// En otros cores poll() ejecuta las etapas en serie.
+//
+// Una fuente (SramSource, TriggerSource, AdcSource, ReplaySource) ofrece:
+//   bool start(FramePool& pool, uint32_t addr, size_t frameLen);
+//   Frame* next(bool& stalled); // trama llena con len/addr, refs = 1;
+//                               // nullptr si no hay (stalled = faltó pool)
+//   void notifyTask(TaskHandle_t task); // solo ESP32: xTaskNotifyGive(task)
+//                                       // cuando puede haber trama nueva
+template <typename Source>
+class Pipeline : public PipelineCore {
+public:
+    Pipeline(Source& source, FramePool& pool) : PipelineCore(pool), _source(source) {}
+    bool begin(uint32_t addr = 0, size_t frameLen = FRAME_BYTES);
+    void poll();
+    bool acquireStep();
+    Source& source() { return _source; }
+
+private:
+#if defined(ARDUINO_ARCH_ESP32)
+    static constexpr TickType_t ACQ_WAIT_TICKS = 1;
+    static void acquireTask(void* arg);
+#endif
+    Source& _source;
+    uint32_t _seq = 0;
+};
+
+template <typename Source>
+bool Pipeline<Source>::begin(uint32_t addr, size_t frameLen) {
+    if (frameLen == 0 || frameLen > _pool.frameBytes()) frameLen = _pool.frameBytes();
+    if (!_source.start(_pool, addr, frameLen)) return false;
+
+    // Adquisición sola en el núcleo 0; procesamiento y salida en el 1
+    startStages();
+#if defined(ARDUINO_ARCH_ESP32)
+    xTaskCreatePinnedToCore(acquireTask, "acq", 4096, this, 3, &_acqTask, 0);
+    _source.notifyTask(_acqTask);
+#endif
+    return true;
+}
+
+template <typename Source>
+void Pipeline<Source>::poll() {
+    acquireStep();
+    processStep();
+    outputStep();
+}
+
+template <typename Source>
+bool Pipeline<Source>::acquireStep() {
+    // Si la etapa siguiente no tiene sitio la fuente espera (en la captura
+    // DMA, en su doble búfer)
+    if (!pushHeld()) return false;
+    if (_acquire && !_acquire()) return false;
+
+    bool stalled = false;
+    Frame* frame = _source.next(stalled);
+    if (!frame) {
+        if (stalled) ++_acqStats.stalls;
+        return false;
+    }
+    frame->seq = _seq++;
+    return emit(frame);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+template <typename Source>
+void Pipeline<Source>::acquireTask(void* arg) {
+    Pipeline* self = static_cast<Pipeline*>(arg);
+    for (;;) {
+        // Sin trama lista se espera al aviso de la fuente o de las etapas
+        // que liberan sitio; el tick es el respaldo para las fuentes que no
+        // avisan (y cede el núcleo: evita el watchdog de IDLE0)
+        if (!self->acquireStep()) ulTaskNotifyTake(pdTRUE, ACQ_WAIT_TICKS);
+    }
+}
+#endif
+
+#endif // PIPELINE_H
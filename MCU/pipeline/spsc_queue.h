@@ -0,0 +1,43 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <atomic>
+
+// Cola sin bloqueos de un productor y un consumidor (cada uno en su tarea).
+// N debe ser potencia de dos.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N && (N & (N - 1)) == 0, "N debe ser potencia de dos");
+
+public:
+    bool push(const T& item) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == N) return false; // llena
+        _buf[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) return false; // vacía
+        item = _buf[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T _buf[N];
+    std::atomic<size_t> _head{0}; // solo lo escribe el productor
+    std::atomic<size_t> _tail{0}; // solo lo escribe el consumidor
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,84 @@
+#include "power.h"
+
+bool PowerScheduler::begin(const PowerConfig& cfg) {
+    _cfg = cfg;
+    _state = POWER_AWAKE;
+    _stats = {0, 0, 0, 0, 0};
+#if defined(ARDUINO_ARCH_ESP32)
+    _enabled = _cfg.pinWake >= 0;
+    if (_enabled) pinMode(_cfg.pinWake, INPUT);
+#else
+    _enabled = false; // sin sueño ligero: se adquiere siempre
+#endif
+    _lastFrameMs = millis();
+    return _enabled;
+}
+
+bool PowerScheduler::wakePending() const {
+    return _cfg.pinWake >= 0 && digitalRead(_cfg.pinWake) == HIGH;
+}
+
+bool PowerScheduler::gate(uint32_t acquired, uint32_t delivered) {
+    if (!_enabled) return true;
+    const uint32_t now = millis();
+
+    if (_state == POWER_AWAKE) {
+        if (acquired != _lastAcquired) {
+            _lastAcquired = acquired;
+            _lastFrameMs = now;
+        }
+        const bool burstDone = _cfg.burstFrames ? acquired - _burstStart >= _cfg.burstFrames
+                                                : now - _lastFrameMs >= _cfg.quietMs;
+        if (!burstDone) return true;
+        _state = POWER_DRAINING;
+    }
+
+    // Nada de dormir con tramas en el pipeline: la latencia de salida no cambia
+    if (delivered != acquired) return false;
+    if ((int32_t)(now - _holdUntilMs) < 0) return false;
+
+    // Si el pin ya está activo hay otra ráfaga lista: se lee sin dormir
+    if (!wakePending() && !sleep()) {
+        // Despertó el timer: tiempo para atender al host y se vuelve a dormir
+        _holdUntilMs = millis() + _cfg.quietMs;
+        return false;
+    }
+
+    _state = POWER_AWAKE;
+    _burstStart = _lastAcquired = acquired;
+    _lastFrameMs = millis();
+    return true;
+}
+
+bool PowerScheduler::sleep() {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_before) _before();
+    _periph.suspend();
+
+    const gpio_num_t pin = (gpio_num_t)_cfg.pinWake;
+    gpio_wakeup_enable(pin, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    if (_cfg.maxSleepMs) esp_sleep_enable_timer_wakeup((uint64_t)_cfg.maxSleepMs * 1000);
+
+    const int64_t t0 = esp_timer_get_time();
+    esp_light_sleep_start();
+    const int64_t t1 = esp_timer_get_time(); // esp_timer sigue durante el sueño
+
+    const bool byPin = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    gpio_wakeup_disable(pin);
+
+    _periph.resume();
+    if (_after) _after();
+
+    const uint32_t restore = (uint32_t)(esp_timer_get_time() - t1);
+    ++_stats.sleeps;
+    _stats.sleptUs += (uint64_t)(t1 - t0);
+    _stats.lastRestoreUs = restore;
+    if (restore > _stats.maxRestoreUs) _stats.maxRestoreUs = restore;
+    if (!byPin) ++_stats.timerWakes;
+    return byPin;
+#else
+    return true;
+#endif
+}
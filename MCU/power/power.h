@@ -0,0 +1,77 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include "../peripherals/peripherals.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#endif
+
+struct PowerConfig {
+    int8_t   pinWake = -1;      // SRAM llena / disparo (activo en alto); -1 = no duerme
+    uint32_t burstFrames = 0;   // tramas por ráfaga; 0 = hasta quietMs sin tramas
+    uint32_t quietMs = 5;       // sin tramas nuevas = fin de ráfaga; también
+                                // lo que se queda despierto tras un timer
+    uint32_t maxSleepMs = 0;    // despertar por timer (comandos, Wi-Fi); 0 = solo GPIO
+};
+
+struct PowerStats {
+    uint32_t sleeps;
+    uint32_t timerWakes;  // despertares sin ráfaga nueva
+    uint64_t sleptUs;
+    uint32_t lastRestoreUs; // del despertar a poder leer la SRAM
+    uint32_t maxRestoreUs;
+};
+
+// Antes de dormir / al despertar (SRAM, UART...)
+typedef void (*PowerHook)();
+
+// Planificador de sueño ligero entre ráfagas. Corre en la tarea de
+// adquisición (desde Pipeline::onAcquire): tras burstFrames tramas deja de
+// adquirir, espera a que la salida entregue todas y duerme hasta que el pin
+// de despertar suba. Para que suba dormido, el reloj de muestreo y el ADC
+// tienen que seguir (PeripheralsConfig::clockInSleep); si no, solo
+// despierta el timer. Al despertar Peripherals::resume() y el gancho
+// (RamReader::resume()) reponen el estado sin reinicializar nada, y el
+// tiempo hasta poder leer queda medido en lastRestoreUs/maxRestoreUs.
+// La latencia de captura a salida no cambia: nunca se duerme con tramas
+// pendientes. Con Wi-Fi, dormir más que unos intervalos de beacon hace que
+// el AP suelte la asociación: conviene maxSleepMs corto o ir sin red.
+class PowerScheduler {
+public:
+    PowerScheduler(Peripherals& periph) : _periph(periph) {}
+    bool begin(const PowerConfig& cfg);
+    void onSleep(PowerHook before, PowerHook after) { _before = before; _after = after; }
+    // Desde la tarea de adquisición (p. ej. al cambiar la ventana leída)
+    void setBurstFrames(uint32_t frames) { _cfg.burstFrames = frames; }
+
+    // acquired: tramas emitidas por la adquisición; delivered: las que ya
+    // terminó la salida. false = no adquirir ahora
+    bool gate(uint32_t acquired, uint32_t delivered);
+
+    bool enabled() const { return _enabled; }
+    const PowerStats& stats() const { return _stats; }
+
+private:
+    enum State : uint8_t { POWER_AWAKE, POWER_DRAINING };
+
+    bool wakePending() const;
+    bool sleep(); // true si despertó el pin (hay ráfaga nueva)
+
+    Peripherals& _periph;
+    PowerConfig _cfg;
+    PowerHook _before = nullptr;
+    PowerHook _after = nullptr;
+    bool _enabled = false;
+    State _state = POWER_AWAKE;
+    uint32_t _burstStart = 0;   // tramas emitidas al empezar la ráfaga
+    uint32_t _lastAcquired = 0;
+    uint32_t _lastFrameMs = 0;
+    uint32_t _holdUntilMs = 0;  // despierto sin ráfaga hasta esta hora
+    PowerStats _stats = {0, 0, 0, 0, 0};
+};
+
+#endif // POWER_H
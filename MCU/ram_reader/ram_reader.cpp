@@ -1,13 +1,54 @@
 #include "ram_reader.h"
 
 RamReader::RamReader(int8_t pinCS, SPIClass* spi)
-    : _cs(pinCS), _spi(spi), _ramSize(1024), _initialized(false) {}
+    : RamReader(pinCS, SramConfig(), spi) {}
+
+RamReader::RamReader(int8_t pinCS, const SramConfig& cfg, SPIClass* spi)
+    : _cs(pinCS), _spi(spi), _ramSize(cfg.sizeBytes), _initialized(false), _cfg(cfg),
+      _host(SpiBus::host(SPI_ROLE_ACQUISITION)) {
+    if (_cfg.clockHz > _cfg.maxClockHz) _cfg.clockHz = _cfg.maxClockHz;
+    if (_cfg.channels == 0) _cfg.channels = 1;
+    _settings = SPISettings(_cfg.clockHz, MSBFIRST, SPI_MODE);
+}
 
 void RamReader::begin() {
     pinMode(_cs, OUTPUT);
     digitalWrite(_cs, HIGH);
 
     _spi->begin(); // pines por defecto
+    SpiBus::addDevice(_host);
+
+    // Lecturas en ráfaga: algunas piezas (23K256) arrancan en modo byte
+    {
+        SpiLock lock(_host, SPI_PRIO_HIGH);
+        writeModeRegister(MODE_SEQUENTIAL);
+    }
+
+    // La detección va por SPIClass, antes de pasar el bus a IDF
+    if (_cfg.sizeBytes == 0 || _cfg.addrBytes == 0) {
+        uint32_t size = _cfg.sizeBytes;
+        uint8_t width = _cfg.addrBytes;
+        if (detectGeometry()) {
+            // Lo fijado a mano tiene prioridad sobre lo detectado
+            if (size) _ramSize = size;
+            if (width) _cfg.addrBytes = width;
+            _cfg.sizeBytes = _ramSize; // no se vuelve a detectar en restart()
+        } else {
+            _ramSize = size;
+            _cfg.addrBytes = width ? width : DEFAULT_ADDR_BYTES;
+        }
+    }
+
+    if (_cfg.mode == SRAM_QUAD_READ) {
+#if defined(ARDUINO_ARCH_ESP32)
+        // SQI necesita SIO2/SIO3 y el driver de IDF (SPIClass es de 1 línea)
+        if (_cfg.pinSio2 < 0 || _cfg.pinSio3 < 0 || !attachDevice()) {
+            _cfg.mode = SRAM_READ;
+        }
+#else
+        _cfg.mode = SRAM_READ;
+#endif
+    }
 
     _initialized = true;
 }
@@ -16,63 +57,253 @@ bool RamReader::isReady() {
     return _initialized;
 }
 
+void RamReader::setReadMode(SramReadMode mode) {
+    if (_capturing || mode == _cfg.mode) return;
+    _cfg.mode = mode;
+    restart();
+}
+
+void RamReader::setClock(uint32_t hz) {
+    if (_capturing) return;
+    if (hz > _cfg.maxClockHz) hz = _cfg.maxClockHz;
+    if (hz == _cfg.clockHz) return;
+    closeStream();
+    _cfg.clockHz = hz;
+    _settings = SPISettings(_cfg.clockHz, MSBFIRST, SPI_MODE);
+#if defined(ARDUINO_ARCH_ESP32)
+    // El reloj del dispositivo IDF se fija al añadirlo: hay que re-adjuntarlo
+    if (_dev) restart();
+#endif
+}
+
+void RamReader::restart() {
+    if (!_initialized) return;
+    end();
+    begin();
+}
+
+void RamReader::setGeometry(uint32_t size, uint8_t addrBytes) {
+    if (_capturing || addrBytes < 1 || addrBytes > 4) return;
+    _ramSize = size;
+    _cfg.sizeBytes = size;
+    _cfg.addrBytes = addrBytes;
+}
+
+bool RamReader::detectGeometry() {
+    if (_capturing) return false;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_dev) return false; // en SQI el bus es de IDF: se detecta antes
+#endif
+    closeStream();
+
+    SpiLock lock(_host, SPI_PRIO_HIGH);
+    const uint8_t saved = _cfg.addrBytes;
+    for (uint8_t width = 3; width >= 2; --width) {
+        if (probeWidth(width)) {
+            _cfg.addrBytes = width;
+            _ramSize = probeSize();
+            return true;
+        }
+    }
+    _cfg.addrBytes = saved;
+    return false;
+}
+
+bool RamReader::probeWidth(uint8_t addrBytes) {
+    // Con un ancho equivocado el último byte de dirección se toma como dato
+    // y ambas escrituras caen en la misma dirección: la primera se pisa.
+    static const uint8_t P[4] = {0xA5, 0x5A, 0xC3, 0x3C};
+    static const uint8_t Q[4] = {0x96, 0x69, 0x0F, 0xF0};
+    constexpr uint32_t ADDR_Q = 16;
+
+    _cfg.addrBytes = addrBytes;
+
+    uint8_t orig0[4], origQ[4], r0[4], rQ[4];
+    rawRead(0, orig0, sizeof(orig0));
+    rawRead(ADDR_Q, origQ, sizeof(origQ));
+
+    rawWrite(0, P, sizeof(P));
+    rawWrite(ADDR_Q, Q, sizeof(Q));
+    rawRead(0, r0, sizeof(r0));
+    rawRead(ADDR_Q, rQ, sizeof(rQ));
+
+    rawWrite(ADDR_Q, origQ, sizeof(origQ));
+    rawWrite(0, orig0, sizeof(orig0));
+
+    return memcmp(r0, P, sizeof(P)) == 0 && memcmp(rQ, Q, sizeof(Q)) == 0;
+}
+
+uint32_t RamReader::probeSize() {
+    // Se marca la dirección 0 y se escribe en potencias de dos crecientes;
+    // la primera que modifica la dirección 0 es la capacidad (se repite).
+    constexpr uint8_t MARK = 0x5A, PROBE = 0xA5;
+    const uint8_t maxBits = 8 * _cfg.addrBytes;
+    uint32_t size = (maxBits >= 32) ? 0 : (1UL << maxBits);
+
+    uint8_t orig0, v;
+    rawRead(0, &orig0, 1);
+    rawWrite(0, &MARK, 1);
+
+    for (uint8_t k = 10; k < maxBits; ++k) {
+        const uint32_t a = 1UL << k;
+        uint8_t saved;
+        rawRead(a, &saved, 1);
+        rawWrite(a, &PROBE, 1);
+        rawRead(0, &v, 1);
+        rawWrite(a, &saved, 1);
+        if (v != MARK) { size = a; break; }
+    }
+
+    rawWrite(0, &orig0, 1);
+    return size;
+}
+
+uint8_t RamReader::readCommand() const {
+    return (_cfg.mode == SRAM_FAST_READ) ? CMD_FAST_READ : CMD_READ;
+}
+
 void RamReader::sendAddress(uint32_t addr) {
-    // Envía _addrBytes más significativos primero (big-endian)
-    for (int8_t i = _addrBytes - 1; i >= 0; --i) {
+    // Envía _cfg.addrBytes más significativos primero (big-endian)
+    for (int8_t i = _cfg.addrBytes - 1; i >= 0; --i) {
         _spi->transfer((addr >> (8 * i)) & 0xFF);
     }
 }
 
 uint8_t RamReader::readByte(uint32_t addr) {
-    if (!_initialized) return 0;
+    if (!_initialized || _capturing) return 0;
 
     // Si limitaste tamaño, evita overflow
     if (_ramSize && addr >= _ramSize) return 0;
 
+    closeStream();
     uint8_t data = 0;
+    SpiLock lock(_host, SPI_PRIO_HIGH);
+    rawRead(addr, &data, 1);
+    return data;
+}
 
-    _spi->beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE));
-    digitalWrite(_cs, LOW);
+void RamReader::readBlock(uint32_t addr, uint8_t* buffer, size_t len) {
+    if (!_initialized || _capturing || buffer == nullptr || len == 0) return;
 
-    _spi->transfer(CMD_READ);
-    sendAddress(addr);
-    // Si usaras FAST_READ (0x0B) necesitarías: _spi->transfer(0x00); // dummy
+    // Seguridad por tamaño conocido
+    len = clampLen(addr, len);
+    if (len == 0) return;
 
-    data = _spi->transfer(0x00); // reloj para recibir un byte
+    TRACE_SCOPE(TRACE_RAM_READ, len);
+#if defined(ARDUINO_ARCH_ESP32)
+    const bool viaSpiClass = !_dev;
+#else
+    const bool viaSpiClass = true;
+#endif
+    // Con el host compartido hay que soltar CS y el bus tras cada ráfaga
+    if (_cfg.continuous && viaSpiClass && !SpiBus::shared(_host)) {
+        streamRead(addr, buffer, len);
+        return;
+    }
+    closeStream();
+    SpiLock lock(_host, SPI_PRIO_HIGH);
+    rawRead(addr, buffer, len);
+}
 
+void RamReader::streamRead(uint32_t addr, uint8_t* buffer, size_t len) {
+    // En modo secuencial la SRAM sigue entregando bytes mientras CS esté en
+    // bajo: si se continúa donde se quedó, sobran comando y dirección
+    if (!_streamOpen || addr != _streamNext) {
+        closeStream();
+        _spi->beginTransaction(_settings);
+        openRead(addr);
+        _streamOpen = true;
+    }
+    clockIn(buffer, len);
+    _streamNext = addr + len;
+}
+
+void RamReader::closeStream() {
+    if (!_streamOpen) return;
     digitalWrite(_cs, HIGH);
     _spi->endTransaction();
+    _streamOpen = false;
+}
 
-    return data;
+size_t RamReader::clampLen(uint32_t addr, size_t len) const {
+    if (!_ramSize) return len;
+    if (addr >= _ramSize) return 0;
+    uint32_t maxlen = _ramSize - addr;
+    return (len > maxlen) ? maxlen : len;
 }
 
-void RamReader::readBlock(uint32_t addr, uint8_t* buffer, size_t len) {
-    if (!_initialized || buffer == nullptr || len == 0) return;
+size_t RamReader::readMany(const RamSegment* segs, size_t count) {
+    if (!_initialized || _capturing || segs == nullptr) return 0;
 
-    // Seguridad por tamaño conocido
-    if (_ramSize) {
-        if (addr >= _ramSize) return;
-        uint32_t maxlen = _ramSize - addr;
-        if (len > maxlen) len = maxlen;
+    closeStream();
+    size_t total = 0;
+    TRACE_SCOPE(TRACE_RAM_READ, count);
+    SpiLock lock(_host, SPI_PRIO_HIGH);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_dev) {
+        // Modo quad: una transacción por segmento, pero con el bus tomado
+        spi_device_acquire_bus(_dev, portMAX_DELAY);
+        for (size_t i = 0; i < count; ++i) {
+            size_t len = clampLen(segs[i].addr, segs[i].len);
+            if (!len || !segs[i].buf) continue;
+            rawRead(segs[i].addr, segs[i].buf, len);
+            total += len;
+        }
+        spi_device_release_bus(_dev);
+        return total;
     }
+#endif
 
-    _spi->beginTransaction(SPISettings(SPI_CLOCK_HZ, MSBFIRST, SPI_MODE));
-    digitalWrite(_cs, LOW);
+    // Si el hueco hasta el siguiente segmento cuesta menos que reabrir la
+    // lectura (comando + dirección + dummy), se clockea y se descarta.
+    const size_t reopenCost = 1 + _cfg.addrBytes + (_cfg.mode == SRAM_FAST_READ ? 1 : 0);
+    uint8_t scratch[8];
+
+    bool open = false;
+    uint32_t next = 0; // dirección que saldría a continuación con CS en bajo
 
-    _spi->transfer(CMD_READ);
+    _spi->beginTransaction(_settings);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t addr = segs[i].addr;
+        size_t len = clampLen(addr, segs[i].len);
+        if (!len || !segs[i].buf) continue;
+
+        if (open && addr >= next && addr - next <= reopenCost) {
+            clockIn(scratch, addr - next);
+        } else {
+            if (open) digitalWrite(_cs, HIGH);
+            openRead(addr);
+            open = true;
+        }
+
+        clockIn(segs[i].buf, len);
+        next = addr + len;
+        total += len;
+    }
+    if (open) digitalWrite(_cs, HIGH);
+    _spi->endTransaction();
+
+    return total;
+}
+
+void RamReader::openRead(uint32_t addr) {
+    // Baja CS y envía comando + dirección (+ dummy); la transacción ya está abierta
+    digitalWrite(_cs, LOW);
+    _spi->transfer(readCommand());
     sendAddress(addr);
-    // Para FAST_READ (0x0B): _spi->transfer(0x00); // 1 dummy byte
+    if (_cfg.mode == SRAM_FAST_READ) _spi->transfer(0x00); // 1 byte dummy
+}
 
-    // Lectura en ráfaga
+void RamReader::clockIn(uint8_t* buffer, size_t len) {
 #if defined(ARDUINO_ARCH_ESP32)
     // En ESP32 hay transferBytes(). Usamos un buffer de ceros para clockear.
     static uint8_t zeros[64] = {0};
-    size_t remaining = len;
-    while (remaining) {
-        size_t n = (remaining > sizeof(zeros)) ? sizeof(zeros) : remaining;
+    while (len) {
+        size_t n = (len > sizeof(zeros)) ? sizeof(zeros) : len;
         _spi->transferBytes(zeros, buffer, n);
-        buffer     += n;
-        remaining  -= n;
+        buffer += n;
+        len    -= n;
     }
 #else
     // Compatible con cualquier core Arduino
@@ -80,16 +311,448 @@ void RamReader::readBlock(uint32_t addr, uint8_t* buffer, size_t len) {
         buffer[i] = _spi->transfer(0x00);
     }
 #endif
+}
+
+void RamReader::rawRead(uint32_t addr, uint8_t* buffer, size_t len) {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_dev) {
+        // Modo quad: el bus es del driver de IDF
+        while (len) {
+            size_t n = (len > DMA_MAX_TRANSFER) ? DMA_MAX_TRANSFER : len;
+            spi_transaction_t t = {};
+            t.flags = transFlags();
+            t.cmd = readCommand();
+            t.addr = addr;
+            t.rxlength = n * 8;
+            t.rx_buffer = buffer;
+            spi_device_polling_transmit(_dev, &t);
+            addr   += n;
+            buffer += n;
+            len    -= n;
+        }
+        return;
+    }
+#endif
+
+    _spi->beginTransaction(_settings);
+    openRead(addr);
+
+    // Lectura en ráfaga
+    clockIn(buffer, len);
+
+    digitalWrite(_cs, HIGH);
+    _spi->endTransaction();
+}
+
+void RamReader::rawWrite(uint32_t addr, const uint8_t* buffer, size_t len) {
+    // Solo por SPIClass (detección de geometría, antes de pasar a IDF)
+    _spi->beginTransaction(_settings);
+    digitalWrite(_cs, LOW);
+
+    _spi->transfer(CMD_WRITE);
+    sendAddress(addr);
+    for (size_t i = 0; i < len; ++i) {
+        _spi->transfer(buffer[i]);
+    }
 
     digitalWrite(_cs, HIGH);
     _spi->endTransaction();
 }
 
+void RamReader::writeModeRegister(uint8_t mode) {
+    _spi->beginTransaction(_settings);
+    digitalWrite(_cs, LOW);
+    _spi->transfer(CMD_WRMR);
+    _spi->transfer(mode);
+    digitalWrite(_cs, HIGH);
+    _spi->endTransaction();
+}
+
 void RamReader::end() {
+    stopCapture();
+    closeStream();
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_dev) detachDevice();
+#endif
+    SpiBus::removeDevice(_host);
     _spi->end();
     _initialized = false;
 }
 
+void RamReader::suspend() {
+    if (!_initialized) return;
+    stopCapture();
+    closeStream();
+    digitalWrite(_cs, HIGH);
+#if defined(ARDUINO_ARCH_ESP32)
+    // En sueño ligero los registros del SPI se conservan; CS no debe flotar
+    gpio_hold_en((gpio_num_t)_cs);
+#endif
+}
 
+void RamReader::resume() {
+#if defined(ARDUINO_ARCH_ESP32)
+    gpio_hold_dis((gpio_num_t)_cs);
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+uint8_t RamReader::dummyCycles() const {
+    switch (_cfg.mode) {
+        case SRAM_FAST_READ: return 8; // 1 byte en 1 línea
+        case SRAM_QUAD_READ: return 2; // 1 byte en 4 líneas
+        default:             return 0;
+    }
+}
+
+uint32_t RamReader::transFlags() const {
+    if (_cfg.mode != SRAM_QUAD_READ) return 0;
+    return SPI_TRANS_MODE_QIO | SPI_TRANS_MULTILINE_CMD | SPI_TRANS_MULTILINE_ADDR;
+}
+
+bool RamReader::attachDevice() {
+    // SPIClass no tiene DMA ni quad: se le quita el bus y se entrega a IDF
+    _spi->end();
+
+    const bool quad = (_cfg.mode == SRAM_QUAD_READ);
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = MOSI;  // SIO0
+    bus.miso_io_num = MISO;  // SIO1
+    bus.sclk_io_num = SCK;
+    bus.quadwp_io_num = quad ? _cfg.pinSio2 : -1;
+    bus.quadhd_io_num = quad ? _cfg.pinSio3 : -1;
+    bus.max_transfer_sz = DMA_MAX_TRANSFER;
+    if (quad) bus.flags = SPICOMMON_BUSFLAG_QUAD;
+
+    spi_device_interface_config_t dev = {};
+    dev.command_bits = 8;
+    dev.address_bits = 8 * _cfg.addrBytes;
+    dev.dummy_bits = dummyCycles();
+    dev.mode = SPI_MODE;
+    dev.clock_speed_hz = _cfg.clockHz;
+    dev.spics_io_num = _cs;
+    dev.queue_size = CAPTURE_SLOTS;
+    dev.flags = SPI_DEVICE_HALFDUPLEX;
+    dev.post_cb = onTransDone;
+
+    if (!SpiBus::attach(_host, bus)) {
+        _spi->begin();
+        return false;
+    }
+    if (spi_bus_add_device(_host, &dev, &_dev) != ESP_OK) {
+        _dev = nullptr;
+        SpiBus::detach(_host);
+        _spi->begin();
+        return false;
+    }
+
+    _devQuad = quad;
+    if (quad) {
+        // Por si la SRAM quedó en SQI de una sesión anterior (no se resetea
+        // junto con el MCU), primero RSTIO en 4 líneas y luego EQIO en 1.
+        sendModeCommand(CMD_RSTIO, true);
+        sendModeCommand(CMD_EQIO, false);
+    }
+    return true;
+}
+
+void RamReader::detachDevice() {
+    if (_devQuad) sendModeCommand(CMD_RSTIO, true);
+    _devQuad = false;
+
+    spi_bus_remove_device(_dev);
+    _dev = nullptr;
+    SpiBus::detach(_host);
+
+    // Se devuelve el bus a SPIClass
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+    _spi->begin();
+}
+
+void RamReader::sendModeCommand(uint8_t cmd, bool quadLines) {
+    // Solo fase de comando: sin dirección, dummy ni datos
+    spi_transaction_ext_t t = {};
+    t.base.flags = SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+    if (quadLines) t.base.flags |= SPI_TRANS_MODE_QIO | SPI_TRANS_MULTILINE_CMD;
+    t.base.cmd = cmd;
+    t.address_bits = 0;
+    t.dummy_bits = 0;
+    spi_device_polling_transmit(_dev, &t.base);
+}
+#endif
+
+bool RamReader::startCapture(uint32_t addr, size_t frameLen, uint32_t frames) {
+    return startCapture(addr, frameLen, frames, nullptr, nullptr);
+}
+
+bool RamReader::startCapture(uint32_t addr, size_t frameLen, uint32_t frames,
+                             uint8_t* buf0, uint8_t* buf1) {
+    frameLen -= frameLen % _cfg.channels;
+    if (!_initialized || frameLen == 0) return false;
+    if (_ramSize && addr >= _ramSize) {
+        stopCapture();
+        return false;
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    if (frameLen > DMA_MAX_TRANSFER) {
+        stopCapture();
+        return false;
+    }
+#endif
+
+    if (frames == 0) {
+        // Hasta el final de la RAM (o una sola trama si no hay tamaño conocido)
+        frames = _ramSize ? (_ramSize - addr + frameLen - 1) / frameLen : 1;
+    }
+
+    if (_capturing) {
+        // Otra vuelta de la misma captura: sin soltar el dispositivo ni el bus
+        const bool sameBufs = _capOwnsBuf ? (buf0 == nullptr || buf1 == nullptr)
+                                          : (buf0 == _capBuf[0] && buf1 == _capBuf[1]);
+        if (captureDone() && frameLen == _capFrameLen && sameBufs) {
+            rearmCapture(addr, frames);
+            return true;
+        }
+        stopCapture();
+    }
+    closeStream();
+
+    // Búferes del llamador (p. ej. tramas del FramePool) o propios
+    _capOwnsBuf = (buf0 == nullptr || buf1 == nullptr);
+    _capBuf[0] = buf0;
+    _capBuf[1] = buf1;
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) {
+        if (_capOwnsBuf) {
+#if defined(ARDUINO_ARCH_ESP32)
+            _capBuf[i] = (uint8_t*)heap_caps_malloc(frameLen, MALLOC_CAP_DMA);
+#else
+            _capBuf[i] = (uint8_t*)malloc(frameLen);
+#endif
+        }
+        _capState[i] = SLOT_FREE;
+        _capLen[i] = 0;
+    }
+    if (!_capBuf[0] || !_capBuf[1]) {
+        freeCaptureBuffers();
+        return false;
+    }
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // En modo quad el dispositivo ya está adjunto
+    if (!_dev && !attachDevice()) {
+        freeCaptureBuffers();
+        return false;
+    }
+#endif
+
+    _capFrameLen = frameLen;
+    _capAddr = addr;
+    _capRemaining = frames;
+    _capHead = 0;
+    _capHeld = false;
+    _capturing = true;
+    // Con el host compartido el bus se toma por ráfaga (una trama en vuelo)
+    // y entre tramas la UI puede usarlo
+    _capShared = SpiBus::shared(_host);
+    _capLocked = false;
+#if defined(ARDUINO_ARCH_ESP32)
+    // CS_KEEP_ACTIVE exige tener el bus del driver en exclusiva; con el host
+    // compartido la UI necesita el bus entre ráfagas, como en streamRead()
+    _capChained = false;
+    _capKeepCs = _cfg.continuous && !_capShared;
+    if (_capKeepCs) spi_device_acquire_bus(_dev, portMAX_DELAY);
+#endif
+
+    // Se encolan ambas tramas para que el bus nunca quede ocioso
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) queueSlot(i);
+    return true;
+}
+
+void RamReader::rearmCapture(uint32_t addr, uint32_t frames) {
+    // Ambos slots están libres: el DMA, CS y la cola del driver siguen como
+    // los dejó la última trama, solo cambian la dirección y la cuenta
+    _capAddr = addr;
+    _capRemaining = frames;
+    _capHead = 0;
+    _capHeld = false;
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) {
+        _capState[i] = SLOT_FREE;
+        _capLen[i] = 0;
+    }
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) queueSlot(i);
+}
+
+void RamReader::queueSlot(uint8_t slot) {
+    if (_capRemaining == 0) return;
+    if (_capShared && _capState[slot ^ 1] == SLOT_BUSY) {
+        // Se encola cuando termine la otra y se haya soltado el bus
+        _capState[slot] = SLOT_WAITING;
+        return;
+    }
+
+    size_t len = _capFrameLen;
+    if (_ramSize) {
+        uint32_t maxlen = (_capAddr < _ramSize) ? _ramSize - _capAddr : 0;
+        if (len > maxlen) len = maxlen - maxlen % _cfg.channels;
+        if (len == 0) {
+            _capRemaining = 0;
+            _capState[slot] = SLOT_FREE; // pudo quedar en espera
+            return;
+        }
+    }
+
+    _capLen[slot] = len;
+    _capState[slot] = SLOT_BUSY;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    spi_transaction_ext_t& x = _capTrans[slot];
+    spi_transaction_t& t = x.base;
+    memset(&x, 0, sizeof(x));
+    t.flags = transFlags();
+    t.cmd = readCommand();
+    t.addr = _capAddr;
+    t.length = 0;            // sin fase de escritura (half-duplex)
+    t.rxlength = len * 8;
+    t.rx_buffer = _capBuf[slot];
+    t.user = &_capDone[slot];
+    if (_capChained) {
+        // CS sigue activo desde la trama anterior: solo datos
+        t.flags |= SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+        x.command_bits = 0;
+        x.address_bits = 0;
+        x.dummy_bits = 0;
+    }
+    // La última trama suelta CS
+    _capChained = _capKeepCs && _capRemaining > 1;
+    if (_capChained) t.flags |= SPI_TRANS_CS_KEEP_ACTIVE;
+    if (!_capLocked) _capLocked = SpiBus::lock(_host, SPI_PRIO_HIGH);
+    spi_device_queue_trans(_dev, &t, portMAX_DELAY);
+#else
+    // Sin DMA: la "transferencia" termina inmediatamente
+    {
+        SpiLock lock(_host, SPI_PRIO_HIGH);
+        rawRead(_capAddr, _capBuf[slot], len);
+    }
+    _capDone[slot].cycles = Peripherals::cycles();
+    _capState[slot] = SLOT_READY;
+#endif
+
+    _capAddr += len;
+    --_capRemaining;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void IRAM_ATTR RamReader::onTransDone(spi_transaction_t* t) {
+    // ISR del driver: la trama terminó de llegar; las lecturas síncronas no
+    // llevan slot
+    if (!t->user) return;
+    SlotDone* done = static_cast<SlotDone*>(t->user);
+    done->cycles = Peripherals::cycles();
+    TaskHandle_t task = done->reader->_notify;
+    if (!task) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+#endif
+
+void RamReader::completeSlot(uint8_t slot) {
+    _capState[slot] = SLOT_READY;
+}
 
+const uint8_t* RamReader::pollFrame(size_t* len) {
+    if (!_capturing) return nullptr;
 
+#if defined(ARDUINO_ARCH_ESP32)
+    // Recoge sin bloquear las transacciones ya terminadas
+    spi_transaction_t* done = nullptr;
+    while (spi_device_get_trans_result(_dev, &done, 0) == ESP_OK) {
+        completeSlot(static_cast<SlotDone*>(done->user)->slot);
+        TRACE_INSTANT(TRACE_RAM_CAPTURE, done->rxlength / 8);
+    }
+    if (_capState[0] != SLOT_BUSY && _capState[1] != SLOT_BUSY) {
+        // Fin de la ráfaga: se suelta el bus y sigue la trama en espera
+        unlockCapture();
+        for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) {
+            if (_capState[i] == SLOT_WAITING) queueSlot(i);
+        }
+    }
+#endif
+
+    if (_capState[_capHead] != SLOT_READY) return nullptr;
+
+    _capHeld = true;
+    if (len) *len = _capLen[_capHead];
+    return _capBuf[_capHead];
+}
+
+void RamReader::releaseFrame(uint8_t* swap) {
+    if (!_capturing || !_capHeld) return;
+
+    // Con swap el llamador se queda el búfer leído y el slot sigue con swap
+    if (swap && !_capOwnsBuf) _capBuf[_capHead] = swap;
+
+    _capHeld = false;
+    _capState[_capHead] = SLOT_FREE;
+    // El slot liberado queda detrás del que está en vuelo: se mantiene el orden
+    queueSlot(_capHead);
+    _capHead ^= 1;
+}
+
+bool RamReader::captureDone() {
+    if (!_capturing) return true;
+    return _capRemaining == 0 &&
+           _capState[0] == SLOT_FREE && _capState[1] == SLOT_FREE;
+}
+
+void RamReader::stopCapture() {
+    if (!_capturing) return;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // Espera a que terminen las transacciones en vuelo antes de soltar el bus
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) {
+        if (_capState[i] != SLOT_BUSY) continue;
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result(_dev, &done, portMAX_DELAY) == ESP_OK) {
+            completeSlot(static_cast<SlotDone*>(done->user)->slot);
+        }
+    }
+    if (_capChained) {
+        // Parada a mitad: una lectura corta sin KEEP_ACTIVE devuelve CS a alto
+        uint8_t scratch[4];
+        spi_transaction_ext_t x = {};
+        x.base.flags = transFlags() | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR |
+                       SPI_TRANS_VARIABLE_DUMMY;
+        x.base.rxlength = 8;
+        x.base.rx_buffer = scratch;
+        spi_device_polling_transmit(_dev, &x.base);
+        _capChained = false;
+    }
+    if (_capKeepCs) spi_device_release_bus(_dev);
+    _capKeepCs = false;
+    // En modo quad el dispositivo sigue adjunto para las lecturas síncronas
+    if (!_devQuad) detachDevice();
+#endif
+
+    unlockCapture();
+    freeCaptureBuffers();
+    _capHeld = false;
+    _capRemaining = 0;
+    _capturing = false;
+}
+
+void RamReader::unlockCapture() {
+    if (!_capLocked) return;
+    SpiBus::unlock(_host, SPI_PRIO_HIGH, true);
+    _capLocked = false;
+}
+
+void RamReader::freeCaptureBuffers() {
+    for (uint8_t i = 0; i < CAPTURE_SLOTS; ++i) {
+        if (_capOwnsBuf) free(_capBuf[i]);
+        _capBuf[i] = nullptr;
+        _capState[i] = SLOT_FREE;
+    }
+}
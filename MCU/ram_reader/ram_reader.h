@@ -3,26 +3,196 @@
 
 #include <Arduino.h>
 #include <SPI.h>
+#include "../trace/trace.h"
+#include "../spi_bus/spi_bus.h"
+#include "../peripherals/peripherals.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/spi_master.h>
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#endif
+
+// Modos de lectura de la SRAM
+enum SramReadMode : uint8_t {
+    SRAM_READ      = 0, // READ 0x03, 1 línea
+    SRAM_FAST_READ = 1, // FAST_READ 0x0B + 1 byte dummy, 1 línea
+    SRAM_QUAD_READ = 2, // SQI (23LC1024): READ 0x03 en 4 líneas + 1 byte dummy
+};
+
+// Configuración de la SRAM externa
+struct SramConfig {
+    SramReadMode mode = SRAM_READ;
+    uint32_t clockHz    = 10'000'000; // reloj pedido
+    uint32_t maxClockHz = 20'000'000; // máximo de la pieza (23LC1024: 20 MHz)
+    uint32_t sizeBytes  = 0;          // 0 = detectar al iniciar
+    uint8_t  addrBytes  = 0;          // 0 = detectar (2 o 3 bytes)
+    int8_t   pinSio2    = -1;         // SIO2/WP, solo modo quad
+    int8_t   pinSio3    = -1;         // SIO3/HOLD, solo modo quad
+    // Lecturas consecutivas sin reenviar comando + dirección: readBlock() deja
+    // CS en bajo si la siguiente empieza donde acabó esta (modo secuencial)
+    bool     continuous = true;
+    // Canales intercalados en la SRAM (c0 c1 .. cN-1 c0 ...): las tramas de
+    // captura se recortan a múltiplo de channels para no partir una muestra
+    uint8_t  channels   = 1;
+};
+
+// Segmento para lecturas dispersas: len bytes desde addr hacia buf
+struct RamSegment {
+    uint32_t addr;
+    uint8_t* buf;
+    size_t len;
+};
 
 class RamReader {
 public:
     RamReader(int8_t pinCS, SPIClass* spi = &SPI);
+    RamReader(int8_t pinCS, const SramConfig& cfg, SPIClass* spi = &SPI);
     void begin();
     bool isReady();
     uint8_t readByte(uint32_t addr);
+    // En modo continuo, una lectura que empieza justo tras la anterior solo
+    // clockea datos (el bus queda tomado, CS en bajo, hasta otra operación,
+    // una dirección no consecutiva o closeStream()).
     void readBlock(uint32_t addr, uint8_t* buffer, size_t len);
+    void closeStream();
+    // Varias lecturas en una sola transacción SPI. Los segmentos contiguos
+    // (o separados por menos bytes que el comando + dirección) se leen sin
+    // soltar CS; conviene pasarlos en orden ascendente. Devuelve los bytes
+    // leídos.
+    size_t readMany(const RamSegment* segs, size_t count);
     void end();
+    // Sueño ligero: suspend() cierra la lectura continua y la captura y
+    // retiene CS en alto; resume() solo suelta la retención. El bus, el
+    // dispositivo IDF (en SQI) y la geometría se conservan, así que la
+    // primera lectura tras despertar no paga end()/begin().
+    void suspend();
+    void resume();
+
+    // Cambian el modo/reloj en caliente (reinician el bus). Con una captura
+    // en curso no tienen efecto.
+    void setReadMode(SramReadMode mode);
+    void setClock(uint32_t hz);
+    SramReadMode readMode() const { return _cfg.mode; }
+    uint32_t clock() const { return _cfg.clockHz; }
+
+    // Geometría de la SRAM. detectGeometry() escribe y relee unos pocos
+    // bytes (restaurándolos) para deducir el ancho de dirección y la
+    // capacidad por el punto donde las direcciones se repiten.
+    // setGeometry() fija ambos a mano; size = 0 quita el límite.
+    bool detectGeometry();
+    void setGeometry(uint32_t size, uint8_t addrBytes);
+    uint32_t size() const { return _ramSize; }
+    uint8_t addrBytes() const { return _cfg.addrBytes; }
+    uint8_t channels() const { return _cfg.channels; }
+
+    // Captura asíncrona en doble búfer (ping-pong). Mientras el consumidor
+    // procesa la trama N, la trama N+1 se transfiere por DMA.
+    // frames = 0 captura hasta el final de la RAM.
+    // Durante la captura no se admiten readByte()/readBlock().
+    // Si la captura anterior terminó (captureDone()) con el mismo tamaño de
+    // trama y los mismos búferes, solo se reencola desde addr: el
+    // dispositivo IDF y el bus siguen tomados entre vueltas. stopCapture()
+    // y end() son los que los sueltan.
+    bool startCapture(uint32_t addr, size_t frameLen, uint32_t frames = 0);
+    // Igual, pero el DMA escribe en búferes del llamador (aptos para DMA)
+    bool startCapture(uint32_t addr, size_t frameLen, uint32_t frames,
+                      uint8_t* buf0, uint8_t* buf1);
+    const uint8_t* pollFrame(size_t* len = nullptr); // nullptr si no hay trama lista
+    // Peripherals::cycles() al terminar el DMA de la trama que entregó pollFrame()
+    uint32_t frameStamp() const { return _capDone[_capHead].cycles; }
+    // Con búferes del llamador, swap reemplaza al búfer recién entregado
+    // (que pasa a ser del llamador) para la siguiente transferencia.
+    void releaseFrame(uint8_t* swap = nullptr);
+    bool captureDone();
+    bool capturing() const { return _capturing; }
+    void stopCapture();
+#if defined(ARDUINO_ARCH_ESP32)
+    // La ISR de fin de cada trama capturada despierta a task (nullptr = nadie)
+    void notifyOnFrame(TaskHandle_t task) { _notify = task; }
+#endif
 
 private:
     void sendAddress(uint32_t addr);
+    void rawRead(uint32_t addr, uint8_t* buffer, size_t len);
+    void streamRead(uint32_t addr, uint8_t* buffer, size_t len);
+    void clockIn(uint8_t* buffer, size_t len);
+    void openRead(uint32_t addr);
+    size_t clampLen(uint32_t addr, size_t len) const;
+    void rawWrite(uint32_t addr, const uint8_t* buffer, size_t len);
+    void writeModeRegister(uint8_t mode);
+    bool probeWidth(uint8_t addrBytes);
+    uint32_t probeSize();
+    void restart();
+    void rearmCapture(uint32_t addr, uint32_t frames);
+    void queueSlot(uint8_t slot);
+    void completeSlot(uint8_t slot);
+    void unlockCapture();
+    void freeCaptureBuffers();
+    uint8_t readCommand() const;
     int8_t _cs;
     SPIClass* _spi;
     uint32_t _ramSize;
     bool _initialized;
-    uint8_t  _addrBytes = 3; // 24 bits de dirección
-    static constexpr uint8_t  CMD_READ = 0x03;
-    static constexpr uint32_t SPI_CLOCK_HZ = 10'000'000; // 10 MHz
+    SramConfig _cfg;
+    SpiHost _host; // el de SPI_ROLE_ACQUISITION, el mismo que usa SPIClass
+    SPISettings _settings; // se rehace solo al cambiar el reloj
+    bool _streamOpen = false;  // readBlock() dejó CS en bajo
+    uint32_t _streamNext = 0;  // dirección que saldría a continuación
+    static constexpr uint8_t  CMD_READ      = 0x03;
+    static constexpr uint8_t  CMD_FAST_READ = 0x0B;
+    static constexpr uint8_t  CMD_WRITE     = 0x02;
+    static constexpr uint8_t  CMD_WRMR      = 0x01; // escribir registro de modo
+    static constexpr uint8_t  MODE_SEQUENTIAL = 0x40;
+    static constexpr uint8_t  DEFAULT_ADDR_BYTES = 3;
+    static constexpr uint8_t  CMD_EQIO      = 0x38; // entrar a modo SQI
+    static constexpr uint8_t  CMD_RSTIO     = 0xFF; // volver a modo SPI
     static constexpr uint8_t  SPI_MODE = SPI_MODE0; // CPOL=0,
+
+    // Estado de la captura
+    // SLOT_WAITING: lista para encolar, a la espera de que termine la otra
+    // (host compartido: una sola trama en vuelo)
+    enum SlotState : uint8_t { SLOT_FREE, SLOT_BUSY, SLOT_READY, SLOT_WAITING };
+    static constexpr uint8_t CAPTURE_SLOTS = 2;
+    uint8_t*  _capBuf[CAPTURE_SLOTS] = {nullptr, nullptr};
+    size_t    _capLen[CAPTURE_SLOTS] = {0, 0};
+    SlotState _capState[CAPTURE_SLOTS] = {SLOT_FREE, SLOT_FREE};
+    uint8_t   _capHead = 0;      // slot de la trama más antigua (orden FIFO)
+    bool      _capHeld = false;  // el consumidor tiene la trama _capHead
+    bool      _capturing = false;
+    bool      _capOwnsBuf = true; // búferes reservados por startCapture()
+    uint32_t  _capAddr = 0;      // dirección de la siguiente trama a encolar
+    uint32_t  _capRemaining = 0; // tramas pendientes de encolar
+    size_t    _capFrameLen = 0;
+    bool      _capShared = false; // host compartido al arrancar la captura
+    bool      _capLocked = false; // SpiBus::lock() tomado para la ráfaga en vuelo
+    // Fin de cada slot; la transacción apunta aquí para que la ISR sepa cuál
+    struct SlotDone {
+        uint8_t slot;
+        volatile uint32_t cycles;
+        RamReader* reader;
+    };
+    SlotDone  _capDone[CAPTURE_SLOTS] = {{0, 0, this}, {1, 0, this}};
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // El driver spi_master de IDF maneja el bus durante la captura (DMA) y,
+    // en modo quad, durante toda la sesión; si no, el bus es de SPIClass.
+    static constexpr size_t DMA_MAX_TRANSFER = 32768;
+    bool attachDevice();
+    void detachDevice();
+    void sendModeCommand(uint8_t cmd, bool quadLines);
+    uint8_t dummyCycles() const;
+    uint32_t transFlags() const;
+    static void IRAM_ATTR onTransDone(spi_transaction_t* t);
+    spi_device_handle_t _dev = nullptr;
+    bool _devQuad = false; // adjunto en SQI (se mantiene toda la sesión)
+    // Las tramas consecutivas van encadenadas con CS activo: solo la primera
+    // lleva comando + dirección (fases variables a 0 bits en las demás)
+    spi_transaction_ext_t _capTrans[CAPTURE_SLOTS];
+    bool _capChained = false; // la última trama encolada dejó CS activo
+    bool _capKeepCs = false;  // continuo con el host en exclusiva: se encadena
+    TaskHandle_t volatile _notify = nullptr;
+#endif
 };
 
 #endif // RAM_READER_H
@@ -0,0 +1,84 @@
+#include "ram_stream.h"
+
+RamStream::RamStream(RamReader& ram, size_t windowLen)
+    : _ram(ram), _window(nullptr), _windowLen(windowLen), _base(0), _size(0),
+      _written(0), _read(0), _overruns(0) {}
+
+bool RamStream::begin(uint32_t base, uint32_t size) {
+    if (!_ram.isReady() || _windowLen == 0) return false;
+
+    if (size == 0) {
+        if (_ram.size() <= base) return false;
+        size = _ram.size() - base;
+    }
+    if (_ram.size() && base + size > _ram.size()) return false;
+
+    if (!_window) _window = (uint8_t*)malloc(_windowLen);
+    if (!_window) return false;
+
+    _base = base;
+    _size = size;
+    reset();
+    return true;
+}
+
+void RamStream::end() {
+    free(_window);
+    _window = nullptr;
+    _size = 0;
+}
+
+void RamStream::reset() {
+    _written = 0;
+    _read = 0;
+    _overruns = 0;
+}
+
+void RamStream::advanceHead(size_t n) {
+    _written += n;
+}
+
+void RamStream::setHead(uint32_t addr) {
+    if (_size == 0 || addr < _base || addr >= _base + _size) return;
+
+    // Se supone que la adquisición avanzó menos de una vuelta desde la última vez
+    uint32_t head = (uint32_t)(_written % _size);
+    uint32_t pos = addr - _base;
+    _written += (pos >= head) ? (pos - head) : (_size - head + pos);
+}
+
+size_t RamStream::available() const {
+    uint64_t pending = _written - _read;
+    return (pending > _size) ? _size : (size_t)pending;
+}
+
+RamSpan RamStream::read(size_t maxLen) {
+    RamSpan span = {_window, 0};
+    // Con una captura en curso readBlock() no lee: la cola no avanza
+    if (!_window || _size == 0 || _ram.capturing()) return span;
+
+    // Si la adquisición dio la vuelta sobre la cola, se salta a lo más antiguo válido
+    if (_written - _read > _size) {
+        _read = _written - _size;
+        ++_overruns;
+    }
+
+    size_t len = (size_t)(_written - _read);
+    if (maxLen == 0 || maxLen > _windowLen) maxLen = _windowLen;
+    if (len > maxLen) len = maxLen;
+    if (len == 0) return span;
+
+    uint32_t pos = (uint32_t)(_read % _size);
+    size_t first = _size - pos;
+    if (first > len) first = len;
+
+    _ram.readBlock(_base + pos, _window, first);
+    if (len > first) {
+        // Vuelta al principio del anillo
+        _ram.readBlock(_base, _window + first, len - first);
+    }
+
+    _read += len;
+    span.len = len;
+    return span;
+}
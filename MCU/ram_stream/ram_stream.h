@@ -0,0 +1,46 @@
+#ifndef RAM_STREAM_H
+#define RAM_STREAM_H
+
+#include <Arduino.h>
+#include "../ram_reader/ram_reader.h"
+
+// Vista sin copia de una porción del anillo. Válida hasta la siguiente
+// llamada a read().
+struct RamSpan {
+    const uint8_t* data;
+    size_t len;
+};
+
+// Cursor sobre la SRAM usada como anillo por la adquisición.
+// La adquisición publica lo escrito con advanceHead()/setHead(); read()
+// entrega lo pendiente desde la cola, partiendo la lectura en dos
+// readBlock() cuando da la vuelta al final del anillo.
+class RamStream {
+public:
+    RamStream(RamReader& ram, size_t windowLen = 512);
+    bool begin(uint32_t base = 0, uint32_t size = 0); // size = 0: toda la RAM
+    void end();
+
+    void advanceHead(size_t n);    // n bytes nuevos escritos por la adquisición
+    void setHead(uint32_t addr);   // o la dirección absoluta de escritura
+    size_t available() const;
+    // maxLen = 0: hasta llenar la ventana. len = 0 si no hay nada pendiente
+    // o si el RamReader está capturando (no admite lecturas síncronas)
+    RamSpan read(size_t maxLen = 0);
+    void reset();
+
+    uint32_t overruns() const { return _overruns; }
+    uint32_t tail() const { return _size ? _base + (uint32_t)(_read % _size) : _base; }
+
+private:
+    RamReader& _ram;
+    uint8_t* _window;
+    size_t _windowLen;
+    uint32_t _base;
+    uint32_t _size;
+    uint64_t _written;   // bytes escritos desde begin() (monótono)
+    uint64_t _read;      // bytes leídos desde begin() (monótono)
+    uint32_t _overruns;  // veces que la adquisición alcanzó a la cola
+};
+
+#endif // RAM_STREAM_H
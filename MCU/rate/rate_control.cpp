@@ -0,0 +1,129 @@
+#include "rate_control.h"
+
+RateControl::RateControl()
+    : _codec(CODEC_DELTA_PACK), _periodStartMs(0), _arrivals(0), _maxDepth(0),
+      _lastStalls(0), _adjustments(0) {
+    memset(_sinks, 0, sizeof(_sinks));
+    for (Sink& s : _sinks) s.decimation = 1;
+}
+
+void RateControl::begin(const RateConfig& cfg) {
+    _cfg = cfg;
+    if (_cfg.periodMs == 0) _cfg.periodMs = 1;
+    if (_cfg.maxDecimation == 0) _cfg.maxDecimation = 1;
+    if (_cfg.busyPercent == 0 || _cfg.busyPercent > 100) _cfg.busyPercent = 100;
+    for (Sink& s : _sinks) s = {1, 0, 0, 0, 0};
+    _codec = _cfg.maxCodec;
+    _periodStartMs = millis();
+    _arrivals = 0;
+    _maxDepth = 0;
+}
+
+bool RateControl::admit(RateSink sink, uint32_t seq) const {
+    const uint8_t n = _sinks[sink].decimation;
+    return n <= 1 || seq % n == 0;
+}
+
+void RateControl::account(RateSink sink, uint32_t us, bool dropped) {
+    Sink& s = _sinks[sink];
+    s.busyUs += us;
+    ++s.frames;
+    if (dropped) ++s.drops;
+}
+
+void RateControl::tick(size_t queueDepth, uint32_t acqStalls) {
+    ++_arrivals;
+    if (queueDepth > _maxDepth) _maxDepth = queueDepth;
+    // Una espera de la adquisición cuenta como cola desbordada
+    if (acqStalls != _lastStalls) {
+        _lastStalls = acqStalls;
+        _maxDepth = SIZE_MAX;
+    }
+
+    const uint32_t now = millis();
+    const uint32_t elapsed = now - _periodStartMs;
+    if (elapsed < _cfg.periodMs) return;
+    adjust(elapsed * 1000);
+    _periodStartMs = now;
+}
+
+void RateControl::backOff(Sink& s) {
+    const uint16_t n = (uint16_t)s.decimation * 2;
+    s.decimation = n > _cfg.maxDecimation ? _cfg.maxDecimation : n;
+    s.calm = 0;
+    ++_adjustments;
+}
+
+void RateControl::adjust(uint32_t periodUs) {
+    uint32_t busy = 0;
+    for (const Sink& s : _sinks) busy += s.busyUs;
+    const uint32_t budget = periodUs / 100 * _cfg.busyPercent;
+    const bool pressure = _maxDepth >= _cfg.highWater || busy > budget;
+
+    // Un enlace que pierde datos se diezma aunque la salida vaya holgada
+    bool linkDrops = false;
+    for (uint8_t i = 0; i < RATE_CODEC; ++i) {
+        Sink& s = _sinks[i];
+        if (!s.drops) continue;
+        if (s.decimation < _cfg.maxDecimation) backOff(s);
+        if (i != RATE_DISPLAY) linkDrops = true;
+    }
+
+    if (pressure) {
+        // Se aligera el que más CPU gastó (y que todavía admite bajar)
+        int8_t worst = -1;
+        for (uint8_t i = 0; i < RATE_SINKS; ++i) {
+            const Sink& s = _sinks[i];
+            const bool canShed = (i == RATE_CODEC) ? _codec > CODEC_RAW
+                                                   : s.decimation < _cfg.maxDecimation && !s.drops;
+            if (canShed && s.busyUs && (worst < 0 || s.busyUs > _sinks[worst].busyUs)) worst = i;
+        }
+        if (worst == RATE_CODEC && !linkDrops) {
+            _codec = (FrameCodec)(_codec - 1); // más barato, menos compacto
+            _sinks[RATE_CODEC].calm = 0;
+            ++_adjustments;
+        } else if (worst >= 0 && worst != RATE_CODEC) {
+            backOff(_sinks[worst]);
+        }
+    }
+
+    if (linkDrops && _codec < _cfg.maxCodec) {
+        _codec = (FrameCodec)(_codec + 1);
+        _sinks[RATE_CODEC].calm = 0;
+        ++_adjustments;
+    }
+
+    if (!pressure) {
+        // Recuperación de a un paso, solo si la carga prevista cabe holgada
+        const uint32_t room = budget / 4 * 3;
+        for (uint8_t i = 0; i < RATE_CODEC; ++i) {
+            Sink& s = _sinks[i];
+            if (s.drops || s.decimation <= 1 || ++s.calm < _cfg.calmPeriods) continue;
+            uint32_t extra = 0;
+            if (s.frames) {
+                const uint64_t perFrame = s.busyUs / s.frames;
+                const uint64_t next = perFrame * _arrivals / (s.decimation - 1);
+                extra = next > s.busyUs ? (uint32_t)(next - s.busyUs) : 0;
+            }
+            if (busy + extra > room) continue;
+            --s.decimation;
+            s.calm = 0;
+            busy += extra;
+            ++_adjustments;
+        }
+        Sink& c = _sinks[RATE_CODEC];
+        if (!linkDrops && _codec < _cfg.maxCodec && ++c.calm >= _cfg.calmPeriods && busy <= room) {
+            _codec = (FrameCodec)(_codec + 1);
+            c.calm = 0;
+            ++_adjustments;
+        }
+    }
+
+    for (Sink& s : _sinks) {
+        s.busyUs = 0;
+        s.frames = 0;
+        s.drops = 0;
+    }
+    _arrivals = 0;
+    _maxDepth = 0;
+}
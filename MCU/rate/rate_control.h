@@ -0,0 +1,72 @@
+#ifndef RATE_CONTROL_H
+#define RATE_CONTROL_H
+
+#include <Arduino.h>
+#include "../codec/codec.h"
+
+// Consumidores de la etapa de salida que se pueden aligerar
+enum RateSink : uint8_t {
+    RATE_UART    = 0, // enlace: una de cada N tramas
+    RATE_NET     = 1, // enlace: una de cada N tramas
+    RATE_DISPLAY = 2, // render() una vez cada N tramas (update() ve todas)
+    RATE_CODEC   = 3, // compresión compartida: no se diezma, cambia de nivel
+    RATE_SINKS   = 4,
+};
+
+struct RateConfig {
+    uint32_t periodMs = 250;       // cada cuánto se reajusta
+    uint8_t  maxDecimation = 64;
+    uint8_t  highWater = 3;        // tramas esperando a la salida = atraso
+    uint8_t  busyPercent = 80;     // tope de CPU de la salida por periodo
+    uint8_t  calmPeriods = 4;      // periodos sin presión antes de bajar N
+    FrameCodec maxCodec = CODEC_DELTA_PACK; // nivel más alto de compresión
+};
+
+// Control de tasa por consumidor con contrapresión. La etapa de salida
+// mide cuánto tarda cada consumidor y si perdió datos (búfer de UART
+// lleno, lotes saltados en Net); cada periodo, si la cola de salida crece,
+// la adquisición tuvo que esperar o la CPU pasa de busyPercent, duplica la
+// decimación del consumidor más caro, y la de todo el que perdió datos.
+// Tras calmPeriods sin presión la baja de a uno, solo si la carga prevista
+// cabe. Así un cliente Wi-Fi lento solo diezma Net: UART y pantalla siguen
+// a la tasa completa. La compresión sube de nivel cuando un enlace pierde
+// datos y baja cuando el tiempo de CPU es el cuello de botella.
+class RateControl {
+public:
+    RateControl();
+    void begin(const RateConfig& cfg = RateConfig());
+
+    // ¿Le toca esta trama al consumidor?
+    bool admit(RateSink sink, uint32_t seq) const;
+    // Lo que costó una entrega (us) y si se perdió
+    void account(RateSink sink, uint32_t us, bool dropped = false);
+    // Una vez por trama de salida: tramas en cola y esperas de la adquisición
+    void tick(size_t queueDepth, uint32_t acqStalls);
+
+    uint8_t decimation(RateSink sink) const { return _sinks[sink].decimation; }
+    FrameCodec codec() const { return _codec; }
+    uint32_t adjustments() const { return _adjustments; }
+
+private:
+    struct Sink {
+        uint8_t  decimation; // 1 = todas las tramas
+        uint8_t  calm;       // periodos seguidos sin presión
+        uint32_t busyUs;     // tiempo de CPU del periodo
+        uint32_t frames;     // entregas del periodo
+        uint32_t drops;      // pérdidas del periodo
+    };
+
+    void adjust(uint32_t periodUs);
+    void backOff(Sink& s);
+
+    RateConfig _cfg;
+    Sink _sinks[RATE_SINKS];
+    FrameCodec _codec;
+    uint32_t _periodStartMs;
+    uint32_t _arrivals;  // tramas que llegaron a la salida en el periodo
+    size_t _maxDepth;
+    uint32_t _lastStalls;
+    uint32_t _adjustments;
+};
+
+#endif // RATE_CONTROL_H
@@ -0,0 +1,24 @@
+#include "adc_source.h"
+
+bool AdcSource::start(FramePool& pool, uint32_t addr, size_t frameLen) {
+    _pool = &pool;
+    _frameLen = frameLen;
+    _offset = addr;
+    return _adc.isReady();
+}
+
+Frame* AdcSource::next(bool& stalled) {
+    if (!_next) _next = _pool->acquire();
+    if (!_next) { stalled = true; return nullptr; }
+
+    const size_t len = _adc.readFrame(_next->data, _frameLen);
+    if (len == 0) return nullptr;
+
+    Frame* frame = _next;
+    _next = nullptr;
+    frame->len = len;
+    frame->addr = _offset;
+    frame->stamp = Peripherals::cycles(); // el driver acaba de entregar el bloque
+    _offset += len;
+    return frame;
+}
@@ -0,0 +1,29 @@
+#ifndef ADC_SOURCE_H
+#define ADC_SOURCE_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+#include "../adc_reader/adc_reader.h"
+#include "../peripherals/peripherals.h"
+
+// Fuente del ADC interno en modo continuo; addr es el índice de la
+// primera muestra de la trama
+class AdcSource {
+public:
+    AdcSource(AdcReader& adc) : _adc(adc) {}
+    bool start(FramePool& pool, uint32_t addr, size_t frameLen);
+    Frame* next(bool& stalled);
+    AdcReader& reader() { return _adc; }
+#if defined(ARDUINO_ARCH_ESP32)
+    void notifyTask(TaskHandle_t task) {} // sin aviso: el pipeline sondea cada tick
+#endif
+
+private:
+    AdcReader& _adc;
+    FramePool* _pool = nullptr;
+    size_t _frameLen = FRAME_BYTES;
+    uint32_t _offset = 0;
+    Frame* _next = nullptr; // reservada antes de leer del driver
+};
+
+#endif // ADC_SOURCE_H
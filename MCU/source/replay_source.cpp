@@ -0,0 +1,41 @@
+#include "replay_source.h"
+
+bool ReplaySource::start(FramePool& pool, uint32_t addr, size_t frameLen) {
+    _pool = &pool;
+    _frameLen = frameLen;
+    _offset = addr;
+    _lastUs = micros();
+    _elapsedUs = 0;
+    _finished = false;
+    return true;
+}
+
+Frame* ReplaySource::next(bool& stalled) {
+    if (_finished) return nullptr;
+
+    // Al ritmo original: la trama sale cuando su última muestra "ocurrió"
+    if (_rate) {
+        const uint32_t now = micros();
+        _elapsedUs += (uint32_t)(now - _lastUs);
+        _lastUs = now;
+        const uint64_t dueUs = (uint64_t)(_offset + _frameLen) * 1'000'000u / _rate;
+        if (_elapsedUs < dueUs) return nullptr;
+    }
+
+    if (!_next) _next = _pool->acquire();
+    if (!_next) { stalled = true; return nullptr; }
+
+    const size_t len = _in.readBytes(_next->data, _frameLen);
+    if (len == 0) {
+        _finished = true;
+        return nullptr;
+    }
+
+    Frame* frame = _next;
+    _next = nullptr;
+    frame->len = len;
+    frame->addr = _offset;
+    frame->stamp = Peripherals::cycles();
+    _offset += len;
+    return frame;
+}
@@ -0,0 +1,33 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+#include "../peripherals/peripherals.h"
+
+// Fuente de reproducción: muestras crudas de 8 bits desde un Stream
+// (archivo de LittleFS/SD, o el puerto serie). Con sampleRateHz > 0 las
+// tramas se entregan al ritmo original; con 0, tan rápido como se lean.
+class ReplaySource {
+public:
+    ReplaySource(Stream& in, uint32_t sampleRateHz = 0) : _in(in), _rate(sampleRateHz) {}
+    bool start(FramePool& pool, uint32_t addr, size_t frameLen);
+    Frame* next(bool& stalled);
+    bool finished() const { return _finished; }
+#if defined(ARDUINO_ARCH_ESP32)
+    void notifyTask(TaskHandle_t task) {} // sin aviso: el pipeline sondea cada tick
+#endif
+
+private:
+    Stream& _in;
+    uint32_t _rate;
+    FramePool* _pool = nullptr;
+    size_t _frameLen = FRAME_BYTES;
+    uint32_t _offset = 0;
+    uint32_t _lastUs = 0;
+    uint64_t _elapsedUs = 0; // desde start(), sin desborde de micros()
+    bool _finished = false;
+    Frame* _next = nullptr;
+};
+
+#endif // REPLAY_SOURCE_H
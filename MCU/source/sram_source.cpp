@@ -0,0 +1,66 @@
+#include "sram_source.h"
+
+bool SramSource::start(FramePool& pool, uint32_t addr, size_t frameLen) {
+    _pool = &pool;
+    _addr = addr;
+    _frameLen = frameLen;
+    return _ram.isReady();
+}
+
+void SramSource::setWindow(uint32_t addr, uint32_t length) {
+    if (addr == _addr && length == _length) return;
+    _addr = addr;
+    _length = length;
+    _ram.stopCapture(); // next() ve captureDone() y arranca en la ventana nueva
+}
+
+bool SramSource::restartCapture() {
+    // Las dos tramas de los slots se conservan entre vueltas a la SRAM, así
+    // que startCapture() solo reencola: el dispositivo y el bus siguen
+    // tomados (setWindow() sí corta con stopCapture())
+    for (uint8_t i = 0; i < 2; ++i) {
+        if (!_capFrame[i]) _capFrame[i] = _pool->acquire();
+        if (!_capFrame[i]) return false;
+    }
+    _offset = 0;
+    _capHead = 0;
+    const uint32_t frames = _length ? (_length + _frameLen - 1) / _frameLen : 0;
+    return _ram.startCapture(_addr, _frameLen, frames, _capFrame[0]->data, _capFrame[1]->data);
+}
+
+Frame* SramSource::next(bool& stalled) {
+    if (_ram.captureDone() && !restartCapture()) return nullptr;
+
+    size_t len = 0;
+    const uint8_t* src = _ram.pollFrame(&len);
+    if (!src) return nullptr;
+
+    // Solo se entrega si hay otra trama libre para el slot
+    Frame* next = _pool->acquire();
+    if (!next) { stalled = true; return nullptr; }
+
+    const uint8_t channels = _ram.channels();
+    const uint32_t stamp = _ram.frameStamp(); // antes de que el slot se reencole
+    Frame* frame;
+    if (_layout == FRAME_PLANAR && channels > 1) {
+        // Los planos van a la trama libre antes de que el slot se reencole
+        // con el mismo búfer; la otra transferencia sigue en vuelo
+        deinterleave(src, len, channels, next->data);
+        _ram.releaseFrame();
+        frame = next;
+    } else {
+        // Sin copia: la trama llena sale del slot y next ocupa su lugar
+        frame = _capFrame[_capHead];
+        _ram.releaseFrame(next->data); // la siguiente lectura arranca ya en este slot
+        _capFrame[_capHead] = next;
+    }
+    _capHead ^= 1;
+
+    frame->len = len;
+    frame->channels = channels;
+    frame->layout = channels > 1 ? _layout : FRAME_INTERLEAVED;
+    frame->addr = _addr + _offset;
+    frame->stamp = stamp;
+    _offset += len;
+    return frame;
+}
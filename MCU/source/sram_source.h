@@ -0,0 +1,45 @@
+#ifndef SRAM_SOURCE_H
+#define SRAM_SOURCE_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+#include "../ram_reader/ram_reader.h"
+
+// Fuente continua: la SRAM se lee entera en vueltas, por DMA en doble búfer.
+// El DMA escribe directamente en tramas del pool; al entregar una, otra
+// libre ocupa su slot (sin copia). Con varios canales en FRAME_PLANAR la
+// separación por canal se hace al completarse el slot: los planos se
+// escriben directamente en la trama libre y el slot sigue con su búfer, así
+// que hay una sola pasada y ninguna copia aparte.
+class SramSource {
+public:
+    SramSource(RamReader& ram, FrameLayout layout = FRAME_INTERLEAVED)
+        : _ram(ram), _layout(layout) {}
+    bool start(FramePool& pool, uint32_t addr, size_t frameLen);
+    void setLayout(FrameLayout layout) { _layout = layout; } // desde la próxima trama
+    // Región leída en vueltas (length = 0: hasta el final de la SRAM). Desde
+    // la tarea de adquisición: la captura en curso se corta y se reanuda ahí
+    void setWindow(uint32_t addr, uint32_t length);
+    Frame* next(bool& stalled);
+    RamReader& reader() { return _ram; }
+#if defined(ARDUINO_ARCH_ESP32)
+    void notifyTask(TaskHandle_t task) { _ram.notifyOnFrame(task); } // fin de cada DMA
+#endif
+
+private:
+    bool restartCapture();
+
+    RamReader& _ram;
+    FrameLayout _layout;
+    FramePool* _pool = nullptr;
+    uint32_t _addr = 0;
+    uint32_t _length = 0;
+    size_t _frameLen = FRAME_BYTES;
+    uint32_t _offset = 0; // desplazamiento de la captura en curso
+
+    // Tramas en las que está escribiendo el DMA, en el orden de los slots
+    Frame* _capFrame[2] = {nullptr, nullptr};
+    uint8_t _capHead = 0;
+};
+
+#endif // SRAM_SOURCE_H
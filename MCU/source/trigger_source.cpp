@@ -0,0 +1,22 @@
+#include "trigger_source.h"
+
+bool TriggerSource::start(FramePool& pool, uint32_t, size_t) {
+    // La región y la ventana salen de TriggerConfig
+    _pool = &pool;
+    return true;
+}
+
+Frame* TriggerSource::next(bool& stalled) {
+    if (!_next) _next = _pool->acquire();
+    if (!_next) { stalled = true; return nullptr; }
+
+    TriggerHit hit;
+    if (!_trigger.scan(hit)) return nullptr;
+
+    Frame* frame = _next;
+    _next = nullptr;
+    frame->len = _trigger.readWindow(hit, frame->data, frame->capacity);
+    frame->addr = hit.start;
+    frame->stamp = Peripherals::cycles(); // ventana recién leída
+    return frame;
+}
@@ -0,0 +1,27 @@
+#ifndef TRIGGER_SOURCE_H
+#define TRIGGER_SOURCE_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+#include "../pds/trigger.h"
+#include "../peripherals/peripherals.h"
+
+// Fuente por disparo: solo las ventanas alrededor de cada disparo, una
+// trama por ventana, en lugar de leer la SRAM entera
+class TriggerSource {
+public:
+    TriggerSource(Trigger& trigger) : _trigger(trigger) {}
+    bool start(FramePool& pool, uint32_t addr, size_t frameLen);
+    Frame* next(bool& stalled);
+    Trigger& trigger() { return _trigger; }
+#if defined(ARDUINO_ARCH_ESP32)
+    void notifyTask(TaskHandle_t task) {} // sin aviso: el pipeline sondea cada tick
+#endif
+
+private:
+    Trigger& _trigger;
+    FramePool* _pool = nullptr;
+    Frame* _next = nullptr; // reservada antes de barrer: el disparo no se pierde
+};
+
+#endif // TRIGGER_SOURCE_H
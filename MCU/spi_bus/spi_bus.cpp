@@ -0,0 +1,90 @@
+#include "spi_bus.h"
+
+SpiBus::HostState SpiBus::_hosts[SpiBus::HOSTS];
+
+SpiHost SpiBus::host(SpiRole role) {
+#if defined(ARDUINO_ARCH_ESP32)
+#if CONFIG_IDF_TARGET_ESP32
+    // VSPI es el SPI global de Arduino: la SRAM sigue donde estaba
+    return (role == SPI_ROLE_ACQUISITION) ? SPI3_HOST : SPI2_HOST;
+#else
+    return (role == SPI_ROLE_ACQUISITION) ? SPI2_HOST : SPI3_HOST;
+#endif
+#else
+    return (SpiHost)(role + 1);
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+bool SpiBus::attach(SpiHost host, const spi_bus_config_t& cfg) {
+    HostState& h = _hosts[host];
+    if (h.busRefs == 0 && spi_bus_initialize(host, &cfg, SPI_DMA_CH_AUTO) != ESP_OK) {
+        return false;
+    }
+    ++h.busRefs;
+    return true;
+}
+
+void SpiBus::detach(SpiHost host) {
+    HostState& h = _hosts[host];
+    if (h.busRefs == 0) return;
+    if (--h.busRefs == 0) spi_bus_free(host);
+}
+#endif
+
+void SpiBus::addDevice(SpiHost host) {
+    HostState& h = _hosts[host];
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!h.mutex) h.mutex = xSemaphoreCreateMutex();
+#endif
+    ++h.devices;
+}
+
+void SpiBus::removeDevice(SpiHost host) {
+    HostState& h = _hosts[host];
+    if (h.devices) --h.devices;
+}
+
+bool SpiBus::shared(SpiHost host) {
+    return _hosts[host].devices > 1;
+}
+
+bool SpiBus::lock(SpiHost host, SpiPriority prio) {
+#if defined(ARDUINO_ARCH_ESP32)
+    HostState& h = _hosts[host];
+    if (h.devices <= 1 || !h.mutex) return false;
+
+    if (prio == SPI_PRIO_HIGH) {
+        // Anunciarse antes de esperar: la UI no empezará otra ráfaga
+        h.highPending.fetch_add(1, std::memory_order_acq_rel);
+        // Salvo la que le tocó al soltar la ráfaga anterior
+        while (h.lowTurn.load(std::memory_order_acquire)) vTaskDelay(1);
+        xSemaphoreTake(h.mutex, portMAX_DELAY);
+    } else {
+        h.lowWaiting.fetch_add(1, std::memory_order_acq_rel);
+        while (h.highPending.load(std::memory_order_acquire) > 0 &&
+               !h.lowTurn.load(std::memory_order_acquire)) {
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(h.mutex, portMAX_DELAY);
+        h.lowWaiting.fetch_sub(1, std::memory_order_acq_rel);
+        h.lowTurn.store(false, std::memory_order_release);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SpiBus::unlock(SpiHost host, SpiPriority prio, bool taken) {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (!taken) return;
+    HostState& h = _hosts[host];
+
+    if (prio == SPI_PRIO_HIGH && h.lowWaiting.load(std::memory_order_acquire) > 0) {
+        h.lowTurn.store(true, std::memory_order_release);
+    }
+    xSemaphoreGive(h.mutex);
+    if (prio == SPI_PRIO_HIGH) h.highPending.fetch_sub(1, std::memory_order_acq_rel);
+#endif
+}
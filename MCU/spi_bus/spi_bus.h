@@ -0,0 +1,85 @@
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/spi_master.h>
+typedef spi_host_device_t SpiHost;
+#else
+typedef uint8_t SpiHost;
+#endif
+
+// Uso del bus: define qué host SPI le toca a cada periférico
+enum SpiRole : uint8_t {
+    SPI_ROLE_ACQUISITION = 0, // SRAM: VSPI en ESP32, FSPI en S2/S3/C3
+    SPI_ROLE_UI          = 1, // pantalla y periféricos lentos: HSPI / SPI3
+};
+
+enum SpiPriority : uint8_t {
+    SPI_PRIO_LOW  = 0, // UI: espera a que no haya lecturas de adquisición pendientes
+    SPI_PRIO_HIGH = 1, // adquisición: nunca espera por la UI más que una ráfaga
+};
+
+// Gestor de los hosts SPI. Reparte hosts por rol, inicializa cada bus de IDF
+// una sola vez aunque lo usen varios dispositivos y arbitra por prioridad los
+// hosts compartidos: la adquisición toma el bus en cuanto termina la ráfaga
+// de UI en curso, y la UI no empieza otra mientras haya adquisición pendiente.
+// Para que la UI no quede sin bus con la adquisición en continuo, al soltar
+// una ráfaga de adquisición con UI esperando le toca a la UI (una ráfaga).
+// Con un solo dispositivo en el host no hay arbitraje (coste cero).
+class SpiBus {
+public:
+    static SpiHost host(SpiRole role);
+
+    // Bus de IDF con cuenta de usuarios (spi_bus_initialize/free)
+#if defined(ARDUINO_ARCH_ESP32)
+    static bool attach(SpiHost host, const spi_bus_config_t& cfg);
+    static void detach(SpiHost host);
+#endif
+
+    // Dispositivos que comparten el host (SPIClass o IDF)
+    static void addDevice(SpiHost host);
+    static void removeDevice(SpiHost host);
+    // Más de un dispositivo: hay que soltar el bus entre ráfagas
+    static bool shared(SpiHost host);
+
+    // Devuelve si tomó el mutex; unlock() recibe ese valor, así que ambos
+    // coinciden aunque cambie la cantidad de dispositivos entre medio
+    static bool lock(SpiHost host, SpiPriority prio);
+    static void unlock(SpiHost host, SpiPriority prio, bool taken);
+
+private:
+    static constexpr uint8_t HOSTS = 3;
+
+    struct HostState {
+        uint8_t busRefs;
+        uint8_t devices;
+        std::atomic<int> highPending;
+        std::atomic<int> lowWaiting;
+        std::atomic<bool> lowTurn; // la próxima ráfaga es de la UI
+#if defined(ARDUINO_ARCH_ESP32)
+        SemaphoreHandle_t mutex;
+#endif
+    };
+
+    static HostState _hosts[HOSTS];
+};
+
+// Toma el bus durante su alcance
+class SpiLock {
+public:
+    SpiLock(SpiHost host, SpiPriority prio)
+        : _host(host), _prio(prio), _taken(SpiBus::lock(host, prio)) {}
+    ~SpiLock() { SpiBus::unlock(_host, _prio, _taken); }
+    SpiLock(const SpiLock&) = delete;
+    SpiLock& operator=(const SpiLock&) = delete;
+
+private:
+    SpiHost _host;
+    SpiPriority _prio;
+    bool _taken;
+};
+
+#endif // SPI_BUS_H
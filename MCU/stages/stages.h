@@ -0,0 +1,143 @@
+#ifndef STAGES_H
+#define STAGES_H
+
+#include <Arduino.h>
+#include "../frame_pool/frame_pool.h"
+#include "../pds/pds.h"
+#include "../pds/pyramid.h"
+#include "../display/display.h"
+#include "../codec/codec.h"
+#include "../uart_comm/uart_comm.h"
+#include "../net/net.h"
+#include "../rate/rate_control.h"
+#include "../command/command.h"
+
+// Partes de las etapas de proceso y salida, para medirlas por separado
+enum FrameStage : uint8_t {
+    STAGE_SPECTRUM,       // Spectrum::push
+    STAGE_DISPLAY_UPDATE, // min/max de la gráfica
+    STAGE_PDS,            // filtros, en su sitio
+    STAGE_PYRAMID,
+    STAGE_CODEC,          // Compressor::compress, en su sitio
+    STAGE_UART,           // trama y último espectro
+    STAGE_NET,            // push() + poll()
+    STAGE_DISPLAY_RENDER,
+    FRAME_STAGES
+};
+
+// Antes (done = false) y después de cada parte; raw = bytes de la trama al
+// entrar a la etapa. El simulador del PC mide así; en la placa no hay sonda.
+typedef void (*StageProbe)(FrameStage stage, bool done, const Frame& frame, size_t raw);
+
+// Cuerpo de las etapas de proceso y salida del pipeline, el mismo en
+// MCU.ino y en host/replay_sim.cpp.
+// process(): la trama cruda va a Spectrum (canal 0, a la tasa completa) y
+// al min/max de la pantalla, para que un pico de una muestra no se pierda
+// en la media ni en el IIR; luego Pds la filtra en su sitio y Pyramid
+// resume el canal 0 ya filtrado.
+// output(): se comprime una vez en su sitio y se reparte a UART, Net y
+// pantalla. Con RateControl cada consumidor se mide y se diezma por
+// separado: el más lento no frena a los demás ni a la adquisición. Sin él
+// todos ven todas las tramas (corridas repetibles).
+// sinks es la máscara StreamSink de CaptureSettings.
+template <typename SpectrumT>
+class FrameStages {
+public:
+    FrameStages(Pds& pds, SpectrumT& spectrum, Pyramid& pyramid, Display& display,
+                Compressor& compressor, UartComm& uart, Net& net)
+        : _pds(pds), _spectrum(spectrum), _pyramid(pyramid), _display(display),
+          _compressor(compressor), _uart(uart), _net(net) {}
+
+    void setRateControl(RateControl* rate) { _rate = rate; }
+    void setProbe(StageProbe probe) { _probe = probe; }
+
+    void process(Frame& frame, uint8_t sinks);
+    void output(Frame& frame, uint8_t sinks);
+
+private:
+    void probe(FrameStage stage, bool done, const Frame& frame, size_t raw) {
+        if (_probe) _probe(stage, done, frame, raw);
+    }
+    bool admit(RateSink sink, uint32_t seq) const { return !_rate || _rate->admit(sink, seq); }
+    void account(RateSink sink, uint32_t t0, bool dropped = false) {
+        if (_rate) _rate->account(sink, micros() - t0, dropped);
+    }
+
+    Pds& _pds;
+    SpectrumT& _spectrum;
+    Pyramid& _pyramid;
+    Display& _display;
+    Compressor& _compressor;
+    UartComm& _uart;
+    Net& _net;
+    RateControl* _rate = nullptr;
+    StageProbe _probe = nullptr;
+};
+
+template <typename SpectrumT>
+void FrameStages<SpectrumT>::process(Frame& frame, uint8_t sinks) {
+    const size_t raw = frame.len;
+    probe(STAGE_SPECTRUM, false, frame, raw);
+    _spectrum.push(frame);
+    probe(STAGE_SPECTRUM, true, frame, raw);
+
+    if (sinks & STREAM_DISPLAY) {
+        probe(STAGE_DISPLAY_UPDATE, false, frame, raw);
+        _display.update(frame); // render() sigue en la salida
+        probe(STAGE_DISPLAY_UPDATE, true, frame, raw);
+    }
+
+    probe(STAGE_PDS, false, frame, raw);
+    _pds.process(frame);
+    probe(STAGE_PDS, true, frame, raw);
+
+    // Ya filtradas, antes de comprimir; en planar el canal 0 es contiguo
+    probe(STAGE_PYRAMID, false, frame, raw);
+    _pyramid.push(frameChannel(frame, 0), frameSamples(frame));
+    probe(STAGE_PYRAMID, true, frame, raw);
+}
+
+template <typename SpectrumT>
+void FrameStages<SpectrumT>::output(Frame& frame, uint8_t sinks) {
+    const size_t raw = frame.len;
+    probe(STAGE_CODEC, false, frame, raw);
+    uint32_t t0 = micros();
+    _compressor.compress(frame); // UART y Net mandan frame.codec
+    account(RATE_CODEC, t0);
+    probe(STAGE_CODEC, true, frame, raw);
+
+    probe(STAGE_UART, false, frame, raw);
+    if ((sinks & STREAM_UART) && admit(RATE_UART, frame.seq)) {
+        // El espectro va con la trama admitida y cuenta en el mismo enlace;
+        // si no, queda pendiente (takeLatest() da siempre el último)
+        t0 = micros();
+        bool sent = _uart.sendFrame(frame); // false = búfer de TX lleno
+        const uint16_t* mag = _spectrum.takeLatest();
+        if (mag) {
+            const size_t bytes = _spectrum.bins() * sizeof(uint16_t);
+            sent = _uart.send((const uint8_t*)mag, bytes, UART_TYPE_SPECTRUM) && sent;
+        }
+        account(RATE_UART, t0, !sent);
+    }
+    probe(STAGE_UART, true, frame, raw);
+
+    // Net no bloquea: la congestión se ve en lotes saltados
+    probe(STAGE_NET, false, frame, raw);
+    t0 = micros();
+    const uint32_t skipped = _net.skipped();
+    if ((sinks & STREAM_NET) && admit(RATE_NET, frame.seq)) _net.push(frame);
+    _net.poll();
+    account(RATE_NET, t0, _net.skipped() != skipped);
+    probe(STAGE_NET, true, frame, raw);
+
+    // update() ya vio la trama cruda: diezmar render() solo agrupa columnas
+    if ((sinks & STREAM_DISPLAY) && admit(RATE_DISPLAY, frame.seq)) {
+        probe(STAGE_DISPLAY_RENDER, false, frame, raw);
+        t0 = micros();
+        _display.render();
+        account(RATE_DISPLAY, t0);
+        probe(STAGE_DISPLAY_RENDER, true, frame, raw);
+    }
+}
+
+#endif // STAGES_H
@@ -0,0 +1,105 @@
+#include "trace.h"
+
+#if TRACE_ENABLED
+
+Trace::Ring Trace::_rings[Trace::CORES];
+Trace::DumpState Trace::_dump = {};
+std::atomic<bool> Trace::_enabled(true);
+
+static const char* const STAGE_NAMES[TRACE_STAGES] = {
+    "ram.read", "ram.capture", "pds", "display", "net", "uart",
+};
+
+void Trace::clear() {
+    for (uint8_t c = 0; c < CORES; ++c) _rings[c].head.store(0, std::memory_order_relaxed);
+}
+
+uint32_t Trace::recorded() {
+    uint32_t n = 0;
+    for (uint8_t c = 0; c < CORES; ++c) n += _rings[c].head.load(std::memory_order_relaxed);
+    return n;
+}
+
+void Trace::beginDump() {
+    if (_dump.phase != DUMP_IDLE) return;
+    _dump.was = _enabled.exchange(false);
+    _dump.first = true;
+    _dump.phase = DUMP_OPEN;
+}
+
+bool Trace::dumping() {
+    return _dump.phase != DUMP_IDLE;
+}
+
+void Trace::loadCore() {
+    // Tiempos relativos al evento más antiguo del anillo
+    const Ring& ring = _rings[_dump.core];
+    const uint32_t head = ring.head.load(std::memory_order_relaxed);
+    const uint32_t count = head < RING_EVENTS ? head : RING_EVENTS;
+    _dump.next = head - count;
+    _dump.end = head;
+    _dump.t0 = count ? ring.events[_dump.next & (RING_EVENTS - 1)].cycles : 0;
+}
+
+bool Trace::dumpSome(Sink sink, uint16_t maxLines) {
+    if (_dump.phase == DUMP_IDLE) return true;
+    if (!sink) return false;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    const float mhz = getCpuFrequencyMhz();
+#else
+    const float mhz = 1; // micros()
+#endif
+
+    // Un objeto por línea; el primero abre el arreglo y el último lo cierra
+    char line[112];
+    for (uint16_t n = 0; n < maxLines; ++n) {
+        switch (_dump.phase) {
+            case DUMP_OPEN:
+                if (!sink("{\"traceEvents\":[")) return false;
+                _dump.core = 0;
+                loadCore();
+                _dump.phase = DUMP_EVENTS;
+                break;
+            case DUMP_EVENTS: {
+                if (_dump.next == _dump.end) {
+                    if (++_dump.core < CORES) loadCore();
+                    else _dump.phase = DUMP_CLOSE;
+                    break;
+                }
+                const TraceEvent& e = _rings[_dump.core].events[_dump.next & (RING_EVENTS - 1)];
+                if (e.stage < TRACE_STAGES) {
+                    snprintf(line, sizeof(line),
+                             "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"n\":%u}}",
+                             _dump.first ? "" : ",", STAGE_NAMES[e.stage], e.phase,
+                             (uint32_t)(e.cycles - _dump.t0) / mhz, _dump.core, e.arg);
+                    if (!sink(line)) return false;
+                    _dump.first = false;
+                }
+                ++_dump.next;
+                break;
+            }
+            case DUMP_CLOSE:
+                if (!sink("]}")) return false;
+                clear();
+                _enabled.store(_dump.was);
+                _dump.phase = DUMP_IDLE;
+                return true;
+            default:
+                return true;
+        }
+    }
+    return false;
+}
+
+#else
+
+// Sin trazas no se reservan los anillos
+std::atomic<bool> Trace::_enabled(false);
+void Trace::beginDump() {}
+bool Trace::dumpSome(Sink, uint16_t) { return true; }
+bool Trace::dumping() { return false; }
+void Trace::clear() {}
+uint32_t Trace::recorded() { return 0; }
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_cpu.h>
+#endif
+
+// Trazas de las etapas calientes. Con TRACE_ENABLED = 0 (por defecto) las
+// macros no generan código.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+enum TraceStage : uint8_t {
+    TRACE_RAM_READ,    // RamReader::readBlock/readMany
+    TRACE_RAM_CAPTURE, // instantáneo: transferencia DMA recogida
+    TRACE_PDS,         // Pds::process
+    TRACE_DISPLAY,     // Display::render
+    TRACE_NET,         // Net::flush
+    TRACE_UART,        // UartComm::send
+    TRACE_STAGES
+};
+
+struct TraceEvent {
+    uint32_t cycles; // contador de ciclos del núcleo que grabó
+    uint8_t  stage;
+    uint8_t  phase;  // 'B' inicio, 'E' fin, 'i' instantáneo
+    uint16_t arg;    // bytes o muestras, según la etapa
+};
+
+// Anillo por núcleo: cada evento reserva su posición con un fetch_add (las
+// tareas del mismo núcleo pueden interrumpirse entre sí) y se escribe en
+// 8 bytes, sin bloqueos. Al llenarse se sobrescriben los más viejos.
+// El volcado es JSON del formato de trazas de Chrome (chrome://tracing,
+// Perfetto): un hilo por núcleo. Los contadores de los dos núcleos no están
+// sincronizados, así que solo se comparan tiempos dentro de un mismo hilo.
+// Sale por partes para no llenar la salida de golpe: beginDump() detiene
+// la grabación y cada dumpSome() emite hasta maxLines líneas mientras el
+// sink las acepte (false = sin sitio: la misma línea se reintenta en la
+// próxima llamada). Al terminar se limpian los anillos y sigue grabando.
+class Trace {
+public:
+    static constexpr uint16_t RING_EVENTS = 1024; // potencia de 2
+    static constexpr uint8_t CORES = 2;
+    typedef bool (*Sink)(const char* text);
+
+    static inline void record(TraceStage stage, uint8_t phase, uint16_t arg = 0);
+    static void beginDump();
+    static bool dumpSome(Sink sink, uint16_t maxLines = 16); // true = terminado
+    static bool dumping();
+    static void clear();
+    static void enable(bool on) { _enabled.store(on, std::memory_order_relaxed); }
+    static uint32_t recorded(); // eventos grabados desde clear()
+
+private:
+#if TRACE_ENABLED
+    struct Ring {
+        std::atomic<uint32_t> head;
+        TraceEvent events[RING_EVENTS];
+    };
+    static Ring _rings[CORES];
+
+    enum DumpPhase : uint8_t { DUMP_IDLE, DUMP_OPEN, DUMP_EVENTS, DUMP_CLOSE };
+    struct DumpState {
+        DumpPhase phase;
+        bool was;      // grabación antes de beginDump()
+        bool first;    // sin coma delante
+        uint8_t core;
+        uint32_t next; // próximo evento del anillo de core
+        uint32_t end;
+        uint32_t t0;   // ciclos del evento más antiguo de core
+    };
+    static DumpState _dump;
+    static void loadCore();
+#endif
+    static std::atomic<bool> _enabled;
+};
+
+inline void Trace::record(TraceStage stage, uint8_t phase, uint16_t arg) {
+#if TRACE_ENABLED
+    if (!_enabled.load(std::memory_order_relaxed)) return;
+#if defined(ARDUINO_ARCH_ESP32)
+    Ring& ring = _rings[xPortGetCoreID()];
+    const uint32_t now = esp_cpu_get_cycle_count();
+#else
+    Ring& ring = _rings[0];
+    const uint32_t now = micros();
+#endif
+    const uint32_t i = ring.head.fetch_add(1, std::memory_order_relaxed) & (RING_EVENTS - 1);
+    ring.events[i] = {now, stage, phase, arg};
+#endif
+}
+
+#if TRACE_ENABLED
+// Marca el tramo desde aquí hasta el final del bloque
+struct TraceScope {
+    TraceStage stage;
+    uint16_t arg;
+    TraceScope(TraceStage s, uint16_t a = 0) : stage(s), arg(a) { Trace::record(s, 'B', a); }
+    ~TraceScope() { Trace::record(stage, 'E', arg); }
+};
+#define TRACE_CAT2(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT2(a, b)
+#define TRACE_SCOPE(stage, arg) TraceScope TRACE_CAT(_trace, __LINE__)(stage, arg)
+#define TRACE_BEGIN(stage, arg) Trace::record(stage, 'B', arg)
+#define TRACE_END(stage, arg) Trace::record(stage, 'E', arg)
+#define TRACE_INSTANT(stage, arg) Trace::record(stage, 'i', arg)
+#else
+#define TRACE_SCOPE(stage, arg) do {} while (0)
+#define TRACE_BEGIN(stage, arg) do {} while (0)
+#define TRACE_END(stage, arg) do {} while (0)
+#define TRACE_INSTANT(stage, arg) do {} while (0)
+#endif
+
+#endif // TRACE_H
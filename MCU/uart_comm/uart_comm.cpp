@@ -1,5 +1,134 @@
 #include "uart_comm.h"
 
-UartComm::UartComm() {}
+UartComm::UartComm(HardwareSerial& port, uint32_t baud)
+    : _port(port), _baud(baud), _compressor(CODEC_RAW), _packet(nullptr),
+      _maxPayload(0), _seq(0), _sent(0), _dropped(0) {}
 
-void UartComm::begin() {}
+void UartComm::begin(size_t maxPayload) {
+    if (_packet) return;
+
+    // El anillo de TX lo vacía la ISR del driver mientras el pipeline sigue;
+    // debe fijarse antes de begin().
+    _port.setTxBufferSize(TX_BUFFER_BYTES);
+    _port.begin(_baud);
+
+    // La carga comprimida nunca supera a la cruda (si no, se manda en crudo)
+    _maxPayload = maxPayload;
+    _packet = (uint8_t*)malloc(HEADER_BYTES + 1 + _maxPayload + CRC_BYTES);
+    _compressor.begin(maxPayload);
+}
+
+bool UartComm::sendFrame(const Frame& frame) {
+    if (!_packet || !frame.data || frame.len > _maxPayload || frame.len >= UINT16_MAX) return false;
+
+    // Formato delante de las muestras: el host separa los canales sin
+    // suponer cuántos hay ni en qué orden
+    uint8_t* payload = _packet + HEADER_BYTES;
+    uint8_t codec = frame.codec;
+    size_t n = frame.len;
+    if (codec == CODEC_RAW) {
+        n = encodePayload(frame.data, frame.len, payload + 1, codec);
+    } else {
+        memcpy(payload + 1, frame.data, n); // ya comprimida en el pipeline
+    }
+    payload[0] = (frameFormat(frame) & 0xF0) | (codec & 0x0F);
+    return sendPacket(n + 1, UART_TYPE_FRAME, codec);
+}
+
+bool UartComm::send(const uint8_t* data, size_t len, UartPacketType type) {
+    if (!_packet || !data || len > _maxPayload || len > UINT16_MAX) return false;
+
+    uint8_t codec;
+    const size_t n = encodePayload(data, len, _packet + HEADER_BYTES, codec);
+    return sendPacket(n, type, codec);
+}
+
+size_t UartComm::encodePayload(const uint8_t* data, size_t len, uint8_t* out, uint8_t& codec) {
+    const size_t n = len ? _compressor.encode(data, len, out, len - 1) : 0;
+    if (n) {
+        codec = _compressor.codec();
+        return n;
+    }
+    memcpy(out, data, len);
+    codec = CODEC_RAW;
+    return len;
+}
+
+bool UartComm::canSend(size_t len) {
+    return _packet && len <= _maxPayload &&
+           (size_t)_port.availableForWrite() >= HEADER_BYTES + len + CRC_BYTES;
+}
+
+bool UartComm::sendPacket(size_t n, UartPacketType type, uint8_t codec) {
+    TRACE_SCOPE(TRACE_UART, n);
+    uint8_t* payload = _packet + HEADER_BYTES;
+    const uint16_t seq = _seq++;
+    _packet[0] = SYNC0;
+    _packet[1] = SYNC1;
+    _packet[2] = (type << 4) | codec;
+    _packet[3] = seq & 0xFF;
+    _packet[4] = seq >> 8;
+    _packet[5] = n & 0xFF;
+    _packet[6] = n >> 8;
+
+    const uint16_t crc = crc16(_packet + 2, HEADER_BYTES - 2 + n);
+    payload[n]     = crc & 0xFF;
+    payload[n + 1] = crc >> 8;
+
+    const size_t total = HEADER_BYTES + n + CRC_BYTES;
+    if ((size_t)_port.availableForWrite() < total) {
+        ++_dropped;
+        return false;
+    }
+    _port.write(_packet, total);
+    ++_sent;
+    return true;
+}
+
+void UartComm::poll() {
+    int avail = _port.available();
+    while (avail-- > 0 && _rxLen < RX_BYTES) _rx[_rxLen++] = (uint8_t)_port.read();
+
+    while (_rxLen >= 2) {
+        // Se resincroniza en el próximo A5 5A
+        if (_rx[0] != SYNC0 || _rx[1] != SYNC1) { consumeRx(1); continue; }
+        if (_rxLen < HEADER_BYTES) return;
+
+        const size_t n = _rx[5] | ((size_t)_rx[6] << 8);
+        const size_t total = HEADER_BYTES + n + CRC_BYTES;
+        if (total > RX_BYTES) { ++_rxErrors; consumeRx(2); continue; }
+        if (_rxLen < total) return; // incompleto
+
+        const uint16_t crc = _rx[HEADER_BYTES + n] | (_rx[HEADER_BYTES + n + 1] << 8);
+        if (crc != crc16(_rx + 2, HEADER_BYTES - 2 + n)) {
+            // Falso sync o bytes perdidos: se busca el siguiente
+            ++_rxErrors;
+            consumeRx(2);
+            continue;
+        }
+        if ((_rx[2] >> 4) == UART_TYPE_COMMAND && _onMessage && _packet) {
+            const size_t r = _onMessage(_rx + HEADER_BYTES, n, _packet + HEADER_BYTES, _maxPayload);
+            if (r) sendPacket(r, UART_TYPE_REPLY, CODEC_RAW);
+        }
+        consumeRx(total);
+    }
+    if (_rxLen == 1 && _rx[0] != SYNC0) _rxLen = 0;
+}
+
+void UartComm::consumeRx(size_t n) {
+    _rxLen -= n;
+    memmove(_rx, _rx + n, _rxLen);
+}
+
+uint16_t UartComm::crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    // CRC-16/CCITT-FALSE, tabla de 16 entradas (medio byte por paso)
+    static const uint16_t TABLE[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for (size_t i = 0; i < len; ++i) {
+        crc = (crc << 4) ^ TABLE[((crc >> 12) ^ (data[i] >> 4)) & 0x0F];
+        crc = (crc << 4) ^ TABLE[((crc >> 12) ^ (data[i] & 0x0F)) & 0x0F];
+    }
+    return crc;
+}
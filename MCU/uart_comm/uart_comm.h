@@ -1,10 +1,85 @@
 #ifndef UART_COMM_H
 #define UART_COMM_H
 
+#include <Arduino.h>
+#include "../trace/trace.h"
+#include "../frame_pool/frame_pool.h"
+#include "../codec/codec.h"
+
+// Contenido del paquete
+enum UartPacketType : uint8_t {
+    UART_TYPE_SAMPLES  = 0, // muestras de 8 bits
+    UART_TYPE_SPECTRUM = 1, // magnitudes uint16 LE de Spectrum
+    UART_TYPE_REPORT   = 2, // línea de texto ASCII (informe de Bench)
+    UART_TYPE_COMMAND  = 3, // host -> MCU, ver CommandChannel
+    UART_TYPE_REPLY    = 4, // respuesta a un comando
+    UART_TYPE_FRAME    = 5, // trama del pipeline: formato (1) | muestras
+};
+
+// Paquete UART_TYPE_COMMAND recibido: puede escribir una respuesta en
+// reply (hasta cap bytes) y devolver su largo; 0 = sin respuesta
+typedef size_t (*UartMessageHook)(const uint8_t* data, size_t len, uint8_t* reply, size_t cap);
+
+// Protocolo binario por UART. Cada paquete:
+//   sync (0xA5 0x5A) | tipo<<4 | codec (1) | seq (2, LE) | len (2, LE) | carga | crc16 (2, LE)
+// El CRC-16/CCITT (0x1021, inicial 0xFFFF) cubre desde tipo/codec hasta la carga.
+// Si la compresión no reduce la carga se envía en crudo. Las tramas que ya
+// pasaron por Compressor se mandan tal cual, con su frame.codec.
+// sendFrame() usa UART_TYPE_FRAME: el primer byte de la carga es el de
+// frameFormat() (codec en bits 0-3, canales - 1 en 4-6, planar en 7, el
+// mismo que usan Net y Logger) y len lo incluye; el codec del nibble
+// describe solo las muestras que siguen.
+// El host manda comandos con el mismo formato de paquete; poll() los junta
+// sin bloquear y descarta los que no pasan el CRC.
 class UartComm {
 public:
-    UartComm();
-    void begin();
+    UartComm(HardwareSerial& port = Serial, uint32_t baud = 2'000'000);
+    void begin(size_t maxPayload = FRAME_BYTES);
+    // Códec para send() y para las tramas que llegan en crudo
+    void setCodec(FrameCodec codec) { _compressor.setCodec(codec); }
+
+    // No bloquea: si el búfer de transmisión no tiene sitio, descarta el
+    // paquete (el host lo ve como un hueco en seq).
+    bool sendFrame(const Frame& frame);
+    bool send(const uint8_t* data, size_t len, UartPacketType type = UART_TYPE_SAMPLES);
+    // Hay sitio en el anillo para len bytes de carga (en crudo, el peor caso)
+    bool canSend(size_t len);
+
+    // Lee lo que haya llegado y atiende los comandos completos
+    void poll();
+    void onMessage(UartMessageHook hook) { _onMessage = hook; }
+
+    uint32_t sent() const { return _sent; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t rxErrors() const { return _rxErrors; } // paquetes entrantes con CRC malo
+
+    static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+private:
+    static constexpr uint8_t SYNC0 = 0xA5;
+    static constexpr uint8_t SYNC1 = 0x5A;
+    static constexpr size_t HEADER_BYTES = 7;
+    static constexpr size_t CRC_BYTES = 2;
+    static constexpr size_t TX_BUFFER_BYTES = 8192; // anillo del driver UART
+    static constexpr size_t RX_BYTES = 64; // los comandos son cortos
+
+    bool sendPacket(size_t n, UartPacketType type, uint8_t codec);
+    // Comprime len bytes en out si rinde; si no, los copia. Devuelve el largo
+    size_t encodePayload(const uint8_t* data, size_t len, uint8_t* out, uint8_t& codec);
+    void consumeRx(size_t n);
+
+    HardwareSerial& _port;
+    uint32_t _baud;
+    Compressor _compressor;
+    uint8_t* _packet;  // cabecera + formato + carga + crc
+    size_t _maxPayload;
+    uint16_t _seq;
+    uint32_t _sent;
+    uint32_t _dropped;
+    UartMessageHook _onMessage = nullptr;
+    uint8_t _rx[RX_BYTES];
+    size_t _rxLen = 0;
+    uint32_t _rxErrors = 0;
 };
 
 #endif // UART_COMM_H